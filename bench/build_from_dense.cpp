@@ -0,0 +1,70 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/dense.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 2u >;
+  // a 4096x4096 occupancy image of free space ( 0 ) with rectangular obstacles
+  constexpr std::size_t width = 4096u;
+  constexpr std::size_t height = 4096u;
+  std::vector< std::uint8_t > image( width * height, 0u );
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< std::size_t > position( 0u, width - 1u );
+  std::uniform_int_distribution< std::size_t > size( 1u, 200u );
+  std::uniform_int_distribution< unsigned int > value( 1u, 3u );
+  for( unsigned int i = 0u; i != 2000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto w = size( rng );
+    const auto h = size( rng );
+    const auto v = std::uint8_t( value( rng ) );
+    for( std::size_t j = y; j < std::min( y + h, height ); ++j )
+      for( std::size_t k = x; k < std::min( x + w, width ); ++k )
+        image[ j * width + k ] = v;
+  }
+  map_t by_update;
+  const auto update_time = measure(
+    [&]() {
+      // one update for each run of equal voxels of a row
+      for( std::size_t y = 0u; y != height; ++y ) {
+        for( std::size_t x = 0u; x != width; ) {
+          auto end = x;
+          while( end != width && image[ y * width + end ] == image[ y * width + x ] ) ++end;
+          if( image[ y * width + x ] ) by_update.update( map_t::rect( map_t::enc( x, y ), map_t::enc( end, y + 1u ) ), std::uint8_t( image[ y * width + x ] ) );
+          x = end;
+        }
+      }
+    }
+  );
+  std::cout << "update per run: " << update_time << "ms nodes=" << by_update.nodes().size() << std::endl;
+  for( unsigned int thread_count: { 1u, 2u, 4u } ) {
+    map_t built;
+    const auto build_time = measure(
+      [&]() {
+        built = hdmap::build_from_dense< map_t >( { width, height }, image.data(), { 1u, width }, std::uint8_t( 0u ), thread_count );
+      }
+    );
+    std::cout << "build_from_dense threads=" << thread_count << ": " << build_time << "ms nodes=" << built.nodes().size() << std::endl;
+  }
+  using flat_map_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 2u, std::equal_to< std::uint8_t >, hdmap::flat_underlying_container_t< std::uint32_t, std::uint8_t, 2u > >;
+  flat_map_t flat_built;
+  const auto flat_build_time = measure(
+    [&]() {
+      flat_built = hdmap::build_from_dense< flat_map_t >( { width, height }, image.data(), { 1u, width }, std::uint8_t( 0u ), 1u );
+    }
+  );
+  std::cout << "build_from_dense flat_underlying_container_t: " << flat_build_time << "ms nodes=" << flat_built.nodes().size() << std::endl;
+}
@@ -0,0 +1,72 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/bulk_load.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 3u >;
+  using flat_map_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 3u, std::equal_to< std::uint8_t >, hdmap::flat_underlying_container_t< std::uint32_t, std::uint8_t, 3u > >;
+  // a voxelized point cloud: samples on the surfaces of spheres, in scan order, with repeated hits
+  std::mt19937 rng( 42u );
+  std::uniform_real_distribution< double > center( 64.0, 448.0 );
+  std::uniform_real_distribution< double > radius( 8.0, 60.0 );
+  std::uniform_real_distribution< double > angle( 0.0, 6.283185307179586 );
+  std::uniform_real_distribution< double > height( -1.0, 1.0 );
+  std::vector< std::pair< map_t::key_type, std::uint8_t > > points;
+  for( unsigned int i = 0u; i != 200u; ++i ) {
+    const auto cx = center( rng );
+    const auto cy = center( rng );
+    const auto cz = center( rng );
+    const auto r = radius( rng );
+    const auto v = std::uint8_t( 1u + i % 3u );
+    for( unsigned int j = 0u; j != 20000u; ++j ) {
+      const auto a = angle( rng );
+      const auto h = height( rng );
+      const auto s = std::sqrt( 1.0 - h * h );
+      points.emplace_back( map_t::enc( unsigned( cx + r * s * std::cos( a ) ), unsigned( cy + r * s * std::sin( a ) ), unsigned( cz + r * h ) ), v );
+    }
+  }
+  map_t by_update;
+  const auto update_time = measure(
+    [&]() {
+      for( const auto &[key,value]: points ) {
+        const auto x = hdmap::detail::get_component< map_t::key_type, 3u >( 0u, key );
+        const auto y = hdmap::detail::get_component< map_t::key_type, 3u >( 1u, key );
+        const auto z = hdmap::detail::get_component< map_t::key_type, 3u >( 2u, key );
+        by_update.update( map_t::rect( key, map_t::enc( x + 1u, y + 1u, z + 1u ) ), std::uint8_t( value ) );
+      }
+    }
+  );
+  std::cout << "points=" << points.size() << std::endl;
+  std::cout << "update per point: " << update_time << "ms nodes=" << by_update.nodes().size() << std::endl;
+  for( unsigned int thread_count: { 1u, 4u } ) {
+    map_t built;
+    const auto build_time = measure(
+      [&]() {
+        built = hdmap::build_from_points< map_t >( points, thread_count );
+      }
+    );
+    std::cout << "build_from_points threads=" << thread_count << ": " << build_time << "ms nodes=" << built.nodes().size() << std::endl;
+  }
+  flat_map_t flat_built;
+  const auto flat_build_time = measure(
+    [&]() {
+      flat_built = hdmap::build_from_points< flat_map_t >( points, 1u );
+    }
+  );
+  std::cout << "build_from_points flat_underlying_container_t: " << flat_build_time << "ms nodes=" << flat_built.nodes().size() << std::endl;
+}
@@ -0,0 +1,103 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <hdmap/concurrent.hpp>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u, std::equal_to< unsigned int >, hdmap::persistent_underlying_container_t< std::uint32_t, unsigned int, 3u > >;
+
+map_t::rect_type random_rect( std::mt19937 &rng, unsigned int max_size ) {
+  std::uniform_int_distribution< unsigned int > position( 0u, 480u );
+  std::uniform_int_distribution< unsigned int > size( 1u, max_size );
+  const auto x = position( rng );
+  const auto y = position( rng );
+  const auto z = position( rng );
+  return map_t::rect( map_t::enc( x, y, z ), map_t::enc( x + size( rng ), y + size( rng ), z + size( rng ) ) );
+}
+
+// Point lookups and updates per second while reader_count readers look up random points and a writer keeps updating small boxes for 500ms.
+// make_reader makes the lookup function for a reader thread and write is called with the box to write.
+template< typename R, typename W >
+std::pair< double, double > run( unsigned int reader_count, R &&make_reader, W &&write ) {
+  std::atomic< bool > done( false );
+  std::atomic< std::size_t > lookups( 0u );
+  std::vector< std::thread > readers;
+  for( unsigned int i = 0u; i != reader_count; ++i ) {
+    readers.emplace_back(
+      [&, i]() {
+        auto read = make_reader();
+        std::mt19937 rng( i );
+        std::uniform_int_distribution< unsigned int > position( 0u, 511u );
+        std::size_t count = 0u;
+        std::vector< map_t::key_type > points( 64u );
+        std::vector< const unsigned int* > found( 64u );
+        while( !done.load( std::memory_order_relaxed ) ) {
+          for( auto &p: points ) p = map_t::enc( position( rng ), position( rng ), position( rng ) );
+          read( points, found );
+          count += points.size();
+        }
+        lookups += count;
+      }
+    );
+  }
+  std::size_t writes = 0u;
+  std::thread writer(
+    [&]() {
+      std::mt19937 rng( 42u );
+      while( !done.load( std::memory_order_relaxed ) ) {
+        write( random_rect( rng, 4u ) );
+        ++writes;
+      }
+    }
+  );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+  done.store( true );
+  for( auto &reader: readers ) reader.join();
+  writer.join();
+  return std::make_pair( double( lookups.load() ) * 2.0, double( writes ) * 2.0 );
+}
+
+int main() {
+  std::mt19937 rng( 1u );
+  map_t initial;
+  for( unsigned int i = 0u; i != 2000u; ++i ) initial.update( random_rect( rng, 16u ), 1u );
+  for( unsigned int reader_count: { 1u, 2u, 4u, 8u } ) {
+    map_t locked_map = initial;
+    std::shared_mutex mutex;
+    const auto locked = run(
+      reader_count,
+      [&]() {
+        return [&]( const auto &points, auto &found ) {
+          std::shared_lock< std::shared_mutex > lock( mutex );
+          locked_map.find_points( points, found );
+        };
+      },
+      [&]( const auto &range ) {
+        std::unique_lock< std::shared_mutex > lock( mutex );
+        locked_map.update( range, 2u );
+      }
+    );
+    hdmap::concurrent_hdmap< map_t > concurrent_map{ map_t( initial ) };
+    const auto lock_free = run(
+      reader_count,
+      [&]() {
+        return [reader=concurrent_map.get_reader()]( const auto &points, auto &found ) {
+          reader.read( [&]( const map_t &m ) { m.find_points( points, found ); } );
+        };
+      },
+      [&]( const auto &range ) {
+        concurrent_map.update( range, 2u );
+      }
+    );
+    std::cout << "readers=" << reader_count <<
+      " shared_mutex: " << locked.first / 1e6 << "M lookups/s " << locked.second << " updates/s" <<
+      " concurrent_hdmap: " << lock_free.first / 1e6 << "M lookups/s " << lock_free.second << " updates/s" << std::endl;
+  }
+}
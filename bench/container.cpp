@@ -0,0 +1,51 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< typename C >
+void run( const char *name, const std::vector< std::uint32_t > &keys ) {
+  C uc;
+  const auto insert_time = measure(
+    [&]() {
+      for( const auto &key: keys )
+        hdmap::detail::insert( uc, 1u, key, std::equal_to< unsigned int >{} );
+    }
+  );
+  std::size_t found_count = 0u;
+  const auto find_time = measure(
+    [&]() {
+      for( const auto &key: keys )
+        if( hdmap::detail::find( uc, key ) != uc.end() ) ++found_count;
+    }
+  );
+  const auto nodes = uc.size();
+  const auto erase_time = measure(
+    [&]() {
+      for( const auto &key: keys )
+        hdmap::detail::erase( uc, key );
+    }
+  );
+  std::cout << name << " nodes: " << nodes << " found: " << found_count << " insert: " << insert_time << "ms find: " << find_time << "ms erase: " << erase_time << "ms" << std::endl;
+}
+
+int main() {
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, 4095u );
+  std::vector< std::uint32_t > keys;
+  for( unsigned int i = 0u; i != 200000u; ++i )
+    keys.push_back( hdmap::detail::to_key< std::uint32_t, 2u >( 0u, dist( rng ), dist( rng ) ) );
+  run< hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u > >( "standard", keys );
+  run< hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > >( "flat", keys );
+}
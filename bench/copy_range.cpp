@@ -0,0 +1,61 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <iostream>
+
+using map_t = hdmap::standard_underlying_container_t< std::uint32_t, std::string, 2u >;
+using rect_t = hdmap::detail::covering_rectangle_t< map_t >;
+
+template< typename F >
+double measure( F &&f, unsigned int iteration ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  for( unsigned int i = 0u; i != iteration; ++i ) f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count() / iteration;
+}
+
+void copy_per_voxel(
+  const map_t &from,
+  const rect_t &range,
+  map_t &to
+) {
+  hdmap::detail::for_each_in_rectangle_region(
+    range,
+    [&]( auto ... p ) {
+      const auto key = hdmap::detail::to_key< std::uint32_t, 2u >( 0u, p... );
+      const auto found = hdmap::detail::find_nearest( from, hdmap::detail::get_root_key< std::uint32_t, 2u >(), key );
+      if( found != from.end() && found->second.is_leaf() && hdmap::detail::contains< std::uint32_t, 2u >( found->second.get_range(), key ) )
+        hdmap::detail::insert( to, std::string( found->second.get_data() ), key, std::equal_to< std::string >{} );
+      return true;
+    }
+  );
+}
+
+int main() {
+  map_t uc;
+  hdmap::detail::insert( uc, std::string( "fuga" ), hdmap::detail::to_key< std::uint32_t, 2u >( 6u, 0x0u, 0x0u ), std::equal_to< std::string >{} );
+  for( unsigned int i = 0u; i != 16u; ++i ) {
+    const auto x = 37u + i * 113u;
+    const auto y = 59u + i * 71u;
+    hdmap::detail::update( uc, "hoge", rect_t{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, x, y ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, x + 3u, y + 5u ) }, std::equal_to< std::string >{} );
+  }
+  for( unsigned int size: { 64u, 256u, 500u, 1024u } ) {
+    const rect_t range{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 13u, 17u ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 13u + size, 17u + size ) };
+    const auto per_voxel = measure(
+      [&]() {
+        map_t copied;
+        copy_per_voxel( uc, range, copied );
+      },
+      1u
+    );
+    const auto hierarchical = measure(
+      [&]() {
+        map_t copied;
+        hdmap::detail::copy( uc, range, copied, std::equal_to< std::string >{}, true );
+      },
+      10u
+    );
+    std::cout << size << "x" << size << " per voxel: " << per_voxel << "ms hierarchical: " << hierarchical << "ms speedup: " << per_voxel / hierarchical << std::endl;
+  }
+}
@@ -0,0 +1,66 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+  // an occupancy map probed with the bounding boxes of a moving robot
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 480u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 16u );
+  map_t map;
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    map.update( map_t::rect( map_t::enc( x, y, z ), map_t::enc( x + size( rng ), y + size( rng ), z + size( rng ) ) ), 1u );
+  }
+  std::uniform_int_distribution< unsigned int > query_size( 4u, 24u );
+  std::vector< map_t::rect_type > queries;
+  for( unsigned int i = 0u; i != 100000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    queries.push_back( map_t::rect( map_t::enc( x, y, z ), map_t::enc( x + query_size( rng ), y + query_size( rng ), z + query_size( rng ) ) ) );
+  }
+  std::size_t find_hits = 0u;
+  std::size_t find_count = 0u;
+  const auto find_time = measure(
+    [&]() {
+      std::vector< map_t::value_type > temp;
+      for( const auto &range: queries ) {
+        temp.clear();
+        map.find( range, temp );
+        if( !temp.empty() ) ++find_hits;
+        for( const auto &v: temp ) find_count += hdmap::detail::get_max_leaf_count( v.first );
+      }
+    }
+  );
+  std::size_t any_hits = 0u;
+  const auto any_time = measure(
+    [&]() {
+      for( const auto &range: queries ) if( map.any( range ) ) ++any_hits;
+    }
+  );
+  std::size_t count = 0u;
+  const auto count_time = measure(
+    [&]() {
+      for( const auto &range: queries ) count += map.count( range );
+    }
+  );
+  std::cout << "nodes: " << map.nodes().size() << std::endl;
+  std::cout << "find: " << find_time << "ms hits: " << find_hits << " voxels: " << find_count << std::endl;
+  std::cout << "any: " << any_time << "ms hits: " << any_hits << std::endl;
+  std::cout << "count: " << count_time << "ms voxels: " << count << std::endl;
+}
@@ -0,0 +1,72 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/cross.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+
+map_t random_map( unsigned int seed ) {
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 2000u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 40u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  map_t map;
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    map.update( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  return map;
+}
+
+int main() {
+  const auto l = random_map( 1u );
+  const auto r = random_map( 2u );
+  hdmap::cross_result_t< map_t, map_t > find_result( hdmap::make_tuple_eq( l.value_eq(), r.value_eq() ) );
+  // find the right map for each leaf of the left map
+  const auto find_time = measure(
+    [&]() {
+      std::vector< map_t::value_type > temp;
+      for( const auto &[lkey,lvalue]: l.leaves() ) {
+        temp.clear();
+        r.find( lkey, temp );
+        for( const auto &[rkey,rvalue]: temp ) find_result.update( rkey, std::make_pair( lvalue, rvalue ) );
+      }
+    }
+  );
+  std::size_t nodes = 0u;
+  const auto cross_time = measure(
+    [&]() {
+      nodes = hdmap::cross( l, r ).nodes().size();
+    }
+  );
+  const auto third = random_map( 3u );
+  std::size_t chained_nodes = 0u;
+  const auto chained_time = measure(
+    [&]() {
+      chained_nodes = hdmap::cross( hdmap::cross( l, r ), third ).nodes().size();
+    }
+  );
+  std::size_t three_nodes = 0u;
+  const auto three_time = measure(
+    [&]() {
+      three_nodes = hdmap::cross( l, r, third ).nodes().size();
+    }
+  );
+  std::cout << "nodes: " << l.nodes().size() << " x " << r.nodes().size() << std::endl;
+  std::cout << "find per leaf: " << find_time << "ms nodes: " << find_result.nodes().size() << std::endl;
+  std::cout << "cross: " << cross_time << "ms nodes: " << nodes << std::endl;
+  std::cout << "cross( cross( l, r ), third ): " << chained_time << "ms nodes: " << chained_nodes << std::endl;
+  std::cout << "cross( l, r, third ): " << three_time << "ms nodes: " << three_nodes << std::endl;
+}
@@ -0,0 +1,50 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  constexpr unsigned int dims = 3u;
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, dims >;
+  using C = std::remove_cvref_t< decltype( std::declval< map_t >().nodes() ) >;
+  // poke holes into a uniform volume
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 509u );
+  std::vector< std::uint32_t > voxels;
+  std::vector< map_t::rect_type > boxes;
+  for( unsigned int i = 0u; i != 20000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    voxels.push_back( hdmap::detail::to_key< std::uint32_t, dims >( 0u, x, y, z ) );
+    boxes.push_back( map_t::rect( map_t::enc( x, y, z ), map_t::enc( x + 2u, y + 2u, z + 2u ) ) );
+  }
+  const auto volume = map_t::rect( map_t::enc( 0u, 0u, 0u ), map_t::enc( 512u, 512u, 512u ) );
+  C poked;
+  hdmap::detail::insert( poked, 1u, volume, std::equal_to< unsigned int >{} );
+  const auto voxel_time = measure(
+    [&]() {
+      for( const auto &voxel: voxels )
+        hdmap::detail::erase( poked, voxel );
+    }
+  );
+  C carved;
+  hdmap::detail::insert( carved, 1u, volume, std::equal_to< unsigned int >{} );
+  const auto box_time = measure(
+    [&]() {
+      for( const auto &box: boxes )
+        hdmap::detail::erase( carved, box );
+    }
+  );
+  std::cout << "nodes: " << poked.size() << "/" << carved.size() << " erase voxel: " << voxel_time << "ms erase box: " << box_time << "ms" << std::endl;
+}
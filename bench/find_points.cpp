@@ -0,0 +1,60 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< typename M >
+void run( const char *name ) {
+  M map;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, 4095u );
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 4096u, 4096u ) ), 5u );
+  for( unsigned int i = 0u; i != 20000u; ++i ) {
+    const auto x = dist( rng );
+    const auto y = dist( rng );
+    map.update( map.rect( map.enc( x, y ), map.enc( x + 1u + i % 13u, y + 1u + i % 11u ) ), i % 5u );
+  }
+  // queries clustered around a few hundred viewpoints, as in a rendered frame
+  std::vector< typename M::key_type > points;
+  std::uniform_int_distribution< unsigned int > offset( 0u, 63u );
+  for( unsigned int i = 0u; i != 500u; ++i ) {
+    const auto x = dist( rng ) & ~63u;
+    const auto y = dist( rng ) & ~63u;
+    for( unsigned int j = 0u; j != 1000u; ++j )
+      points.push_back( map.enc( x + offset( rng ), y + offset( rng ) ) );
+  }
+  std::size_t loop_count = 0u;
+  auto nodes = map.nodes();
+  const auto loop_time = measure(
+    [&]() {
+      for( const auto &point: points )
+        if( hdmap::detail::find( nodes, hdmap::key_cast< std::uint32_t, 2u >( point ) ) != nodes.end() ) ++loop_count;
+    }
+  );
+  std::vector< const unsigned int* > found( points.size() );
+  std::size_t batch_count = 0u;
+  const auto batch_time = measure(
+    [&]() {
+      map.find_points( points, found );
+      for( const auto &f: found )
+        if( f ) ++batch_count;
+    }
+  );
+  std::cout << name << " found: " << loop_count << "/" << batch_count << " loop: " << loop_time << "ms find_points: " << batch_time << "ms" << std::endl;
+}
+
+int main() {
+  run< hdmap::hdmap< std::uint32_t, unsigned int, 2u > >( "standard" );
+  run< hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > > >( "flat" );
+}
@@ -0,0 +1,48 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< unsigned int dims >
+void run( unsigned int extent, unsigned int max_size ) {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, dims >;
+  using C = std::remove_cvref_t< decltype( std::declval< map_t >().nodes() ) >;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, extent - max_size );
+  std::uniform_int_distribution< unsigned int > size( 1u, max_size );
+  std::vector< typename map_t::rect_type > ranges;
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    typename map_t::rect_type range{ hdmap::detail::to_key< typename map_t::key_type, dims >( 0u ), hdmap::detail::to_key< typename map_t::key_type, dims >( 0u ) };
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      const auto begin = position( rng );
+      hdmap::detail::set_component< typename map_t::key_type, dims >( j, range.left_top, begin );
+      hdmap::detail::set_component< typename map_t::key_type, dims >( j, range.right_bottom, begin + size( rng ) );
+    }
+    ranges.push_back( range );
+  }
+  // insert only writes into empty space, so each range is erased first like update does
+  C map;
+  double insert_time = 0.0;
+  double erase_time = 0.0;
+  for( unsigned int i = 0u; i != ranges.size(); ++i ) {
+    erase_time += measure( [&]() { hdmap::detail::erase( map, ranges[ i ] ); } );
+    insert_time += measure( [&]() { hdmap::detail::insert( map, i % 4u, ranges[ i ], std::equal_to< unsigned int >{} ); } );
+  }
+  const auto node_count = map.size();
+  std::cout << dims << "D nodes: " << node_count << " insert: " << insert_time << "ms erase: " << erase_time << "ms" << std::endl;
+}
+
+int main() {
+  run< 2u >( 4096u, 64u );
+  run< 3u >( 512u, 24u );
+}
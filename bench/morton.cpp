@@ -0,0 +1,103 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/morton.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< typename M >
+void fill( M &map ) {
+  // boxes of random size scattered over the map
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 480u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 16u );
+  for( unsigned int i = 0u; i != 2000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    map.update( map.rect( map.enc( x, y, z ), map.enc( x + size( rng ), y + size( rng ), z + size( rng ) ) ), std::uint8_t( 1u + i % 3u ) );
+  }
+}
+
+template< typename M >
+void run( const char *name ) {
+  M map;
+  const auto fill_time = measure( [&]() { fill( map ); } );
+  // a scan over a block, as a ray caster or a convolution reads it
+  std::vector< typename M::key_type > points;
+  for( unsigned int z = 128u; z != 256u; ++z )
+    for( unsigned int y = 128u; y != 256u; ++y )
+      for( unsigned int x = 128u; x != 256u; ++x )
+        points.push_back( M::enc( x, y, z ) );
+  std::vector< const std::uint8_t* > found( points.size() );
+  const auto find_time = measure(
+    [&]() {
+      for( unsigned int i = 0u; i != 4u; ++i ) map.find_points( points, found );
+    }
+  );
+  std::cout << name << ": fill " << fill_time << "ms find_points " << find_time << "ms nodes=" << map.nodes().size() << std::endl;
+  // each update after a snapshot copies the path of its nodes
+  std::mt19937 rng( 7u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 500u );
+  const auto snapshot_time = measure(
+    [&]() {
+      for( unsigned int i = 0u; i != 2000u; ++i ) {
+        const auto snapshot = map.snapshot();
+        const auto x = position( rng );
+        const auto y = position( rng );
+        const auto z = position( rng );
+        map.update( map.rect( map.enc( x, y, z ), map.enc( x + 4u, y + 4u, z + 4u ) ), std::uint8_t( 4u ) );
+      }
+    }
+  );
+  std::cout << name << ": snapshot and update " << snapshot_time << "ms" << std::endl;
+}
+
+int main() {
+  using T = std::uint32_t;
+  constexpr unsigned int dims = 3u;
+  std::vector< T > keys;
+  std::mt19937 rng( 1u );
+  std::uniform_int_distribution< unsigned int > component( 0u, hdmap::detail::get_component_max< T, dims >() );
+  for( unsigned int i = 0u; i != 4000000u; ++i )
+    keys.push_back( hdmap::detail::to_key< T, dims >( 0u, component( rng ), component( rng ), component( rng ) ) );
+  std::uint64_t sum = 0u;
+  const auto portable_time = measure(
+    [&]() {
+      for( const auto key: keys ) sum += hdmap::detail::get_morton_code_portable< T, dims >( key );
+    }
+  );
+  const auto code_time = measure(
+    [&]() {
+      for( const auto key: keys ) sum += hdmap::detail::get_morton_code< T, dims >( key );
+    }
+  );
+  const auto decode_time = measure(
+    [&]() {
+      for( const auto key: keys ) sum += hdmap::from_morton_key< T, dims >( hdmap::to_morton_key< T, dims >( key ) );
+    }
+  );
+#if defined( __BMI2__ )
+  std::cout << "pdep/pext: yes" << std::endl;
+#else
+  std::cout << "pdep/pext: no" << std::endl;
+#endif
+  std::cout << "encode portable: " << portable_time << "ms" << std::endl;
+  std::cout << "encode: " << code_time << "ms" << std::endl;
+  std::cout << "round trip: " << decode_time << "ms ( " << sum << " )" << std::endl;
+  run< hdmap::hdmap< T, std::uint8_t, dims, std::equal_to< std::uint8_t >, hdmap::persistent_underlying_container_t< T, std::uint8_t, dims > > >( "persistent, key_hash" );
+  run< hdmap::hdmap< T, std::uint8_t, dims, std::equal_to< std::uint8_t >, hdmap::persistent_underlying_container_t< T, std::uint8_t, dims, hdmap::morton_key_hash< T, dims > > > >( "persistent, morton_key_hash" );
+}
+
@@ -0,0 +1,67 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/overlay.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+
+map_t random_map( unsigned int seed ) {
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 2000u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 40u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  map_t map;
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    map.update( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  return map;
+}
+
+int main() {
+  // obstacles layered with a second map, and obstacles minus cleared
+  const auto a = random_map( 1u );
+  const auto b = random_map( 2u );
+  map_t update_union;
+  const auto update_union_time = measure(
+    [&]() {
+      update_union = a;
+      for( const auto &[range,value]: b.leaves() ) update_union.update( range, unsigned( value ) );
+    }
+  );
+  map_t overlay_union;
+  const auto overlay_union_time = measure(
+    [&]() {
+      overlay_union = hdmap::overlay( a, b, []( unsigned int, unsigned int r ) { return r; } );
+    }
+  );
+  map_t erase_difference;
+  const auto erase_difference_time = measure(
+    [&]() {
+      erase_difference = a;
+      for( const auto &[range,value]: b.leaves() ) erase_difference.erase( range );
+    }
+  );
+  map_t subtract_difference;
+  const auto subtract_difference_time = measure(
+    [&]() {
+      subtract_difference = hdmap::subtract( a, b );
+    }
+  );
+  std::cout << "nodes: " << a.nodes().size() << " + " << b.nodes().size() << std::endl;
+  std::cout << "update per leaf: " << update_union_time << "ms nodes: " << update_union.nodes().size() << " voxels: " << update_union.size() << std::endl;
+  std::cout << "overlay: " << overlay_union_time << "ms nodes: " << overlay_union.nodes().size() << " voxels: " << overlay_union.size() << std::endl;
+  std::cout << "erase per leaf: " << erase_difference_time << "ms nodes: " << erase_difference.nodes().size() << " voxels: " << erase_difference.size() << std::endl;
+  std::cout << "subtract: " << subtract_difference_time << "ms nodes: " << subtract_difference.nodes().size() << " voxels: " << subtract_difference.size() << std::endl;
+}
@@ -0,0 +1,48 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  // repaint a grid of tiles over and over, most updates are aligned to existing nodes
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > tile( 0u, 63u );
+  std::uniform_int_distribution< unsigned int > offset( 0u, 3u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  std::vector< map_t::value_type > updates;
+  for( unsigned int i = 0u; i != 100000u; ++i ) {
+    const auto x = tile( rng ) * 16u + ( i % 4u ? 0u : offset( rng ) );
+    const auto y = tile( rng ) * 16u;
+    updates.emplace_back( map_t::rect( map_t::enc( x, y ), map_t::enc( x + 16u, y + 16u ) ), value( rng ) );
+  }
+  map_t fused;
+  std::remove_cvref_t< decltype( fused.nodes() ) > classic;
+  fused.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 1024u, 1024u ) ), 0u );
+  hdmap::detail::insert( classic, 0u, map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 1024u, 1024u ) ), std::equal_to< unsigned int >{} );
+  const auto classic_time = measure(
+    [&]() {
+      for( const auto &[range,v]: updates ) {
+        hdmap::detail::erase( classic, range );
+        hdmap::detail::insert( classic, v, range, std::equal_to< unsigned int >{} );
+      }
+    }
+  );
+  const auto fused_time = measure(
+    [&]() {
+      for( const auto &[range,v]: updates )
+        fused.update( range, unsigned( v ) );
+    }
+  );
+  std::cout << "nodes: " << classic.size() << "/" << fused.nodes().size() << " erase + insert: " << classic_time << "ms update: " << fused_time << "ms" << std::endl;
+}
@@ -0,0 +1,90 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 2u >;
+  using map3_t = hdmap::hdmap< std::uint32_t, std::uint8_t, 3u >;
+  // an occupancy map with large free areas and some obstacles, read back as a 4096x4096 texture
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 4000u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 200u );
+  map_t map;
+  map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 4096u, 4096u ) ), std::uint8_t( 1u ) );
+  for( unsigned int i = 0u; i != 2000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    map.update( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), std::uint8_t( 2u + i % 3u ) );
+  }
+  constexpr std::size_t width = 4096u;
+  constexpr std::size_t height = 4096u;
+  const auto range = map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( width, height ) );
+  std::vector< std::uint8_t > painted( width * height );
+  const auto paint_time = measure(
+    [&]() {
+      std::fill( painted.begin(), painted.end(), std::uint8_t( 0u ) );
+      map.find(
+        range,
+        [&]( const map_t::rect_type &r, const std::uint8_t &v ) {
+          for( auto y = hdmap::detail::get_component< map_t::key_type, 2u >( 1u, r.left_top ); y != hdmap::detail::get_component< map_t::key_type, 2u >( 1u, r.right_bottom ); ++y )
+            for( auto x = hdmap::detail::get_component< map_t::key_type, 2u >( 0u, r.left_top ); x != hdmap::detail::get_component< map_t::key_type, 2u >( 0u, r.right_bottom ); ++x )
+              painted[ y * width + x ] = v;
+        }
+      );
+    }
+  );
+  std::vector< std::uint8_t > raster( width * height );
+  const auto rasterize_time = measure(
+    [&]() {
+      map.rasterize( range, raster.data(), { 1u, width }, std::uint8_t( 0u ) );
+    }
+  );
+  std::vector< std::uint8_t > copied( width * height );
+  const auto memcpy_time = measure(
+    [&]() {
+      std::memcpy( copied.data(), raster.data(), raster.size() );
+    }
+  );
+  std::cout << "2D 4096x4096 nodes=" << map.nodes().size() << " find and paint: " << paint_time << "ms rasterize: " << rasterize_time << "ms memcpy: " << memcpy_time << "ms" << ( painted == raster ? "" : " mismatch" ) << std::endl;
+  // a uniform area is written by rows of the whole width
+  map_t uniform;
+  uniform.update( range, std::uint8_t( 1u ) );
+  const auto uniform_time = measure(
+    [&]() {
+      uniform.rasterize( range, raster.data(), { 1u, width }, std::uint8_t( 0u ) );
+    }
+  );
+  std::cout << "2D 4096x4096 uniform rasterize: " << uniform_time << "ms" << std::endl;
+  // a horizontal slice of a 3D map
+  map3_t map3;
+  map3.update( map3_t::rect( map3_t::enc( 0u, 0u, 0u ), map3_t::enc( 512u, 512u, 256u ) ), std::uint8_t( 1u ) );
+  std::uniform_int_distribution< unsigned int > position3( 0u, 480u );
+  for( unsigned int i = 0u; i != 300u; ++i ) {
+    const auto x = position3( rng );
+    const auto y = position3( rng );
+    const auto z = position3( rng );
+    map3.update( map3_t::rect( map3_t::enc( x, y, z ), map3_t::enc( x + 30u, y + 30u, z + 30u ) ), std::uint8_t( 2u ) );
+  }
+  std::vector< std::uint8_t > slice( 512u * 512u );
+  double slice_time = 0.0;
+  for( unsigned int z = 0u; z != 512u; z += 8u ) {
+    slice_time += measure(
+      [&]() {
+        map3.rasterize( map3_t::rect( map3_t::enc( 0u, 0u, z ), map3_t::enc( 512u, 512u, z + 1u ) ), slice.data(), { 1u, 512u, 0u }, std::uint8_t( 0u ) );
+      }
+    );
+  }
+  std::cout << "3D 512x512 slices nodes=" << map3.nodes().size() << " rasterize: " << slice_time / 64.0 << "ms per slice" << std::endl;
+}
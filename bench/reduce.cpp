@@ -0,0 +1,66 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u >, hdmap::max_aggregate< unsigned int > >;
+  // a cost map made of small patches, queried for the maximum cost over large boxes
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 2000u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 16u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 255u );
+  map_t map;
+  for( unsigned int i = 0u; i != 20000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    map.update( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  std::uniform_int_distribution< unsigned int > query_position( 0u, 1000u );
+  std::uniform_int_distribution< unsigned int > query_size( 200u, 1000u );
+  std::vector< map_t::rect_type > queries;
+  for( unsigned int i = 0u; i != 200u; ++i ) {
+    const auto x = query_position( rng );
+    const auto y = query_position( rng );
+    queries.push_back( map_t::rect( map_t::enc( x, y ), map_t::enc( x + query_size( rng ), y + query_size( rng ) ) ) );
+  }
+  unsigned int find_checksum = 0u;
+  const auto find_time = measure(
+    [&]() {
+      std::vector< map_t::value_type > temp;
+      for( const auto &range: queries ) {
+        temp.clear();
+        map.find( range, temp );
+        unsigned int max = 0u;
+        for( const auto &v: temp ) max = std::max( max, v.second );
+        find_checksum += max;
+      }
+    }
+  );
+  unsigned int uncached_checksum = 0u;
+  const auto uncached_time = measure(
+    [&]() {
+      for( const auto &range: queries ) uncached_checksum += map.reduce( range, hdmap::max_aggregate< unsigned int >{} ).value_or( 0u );
+    }
+  );
+  unsigned int cached_checksum = 0u;
+  const auto cached_time = measure(
+    [&]() {
+      for( const auto &range: queries ) cached_checksum += map.reduce( range ).value_or( 0u );
+    }
+  );
+  std::cout << "nodes: " << map.nodes().size() << std::endl;
+  std::cout << "find + max: " << find_time << "ms checksum: " << find_checksum << std::endl;
+  std::cout << "reduce without cache: " << uncached_time << "ms checksum: " << uncached_checksum << std::endl;
+  std::cout << "reduce: " << cached_time << "ms checksum: " << cached_checksum << std::endl;
+}
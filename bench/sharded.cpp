@@ -0,0 +1,76 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/sharded.hpp>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+using sharded_t = hdmap::sharded_hdmap< std::uint32_t, unsigned int, 3u >;
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+
+int main() {
+  // mapping threads each integrating small boxes around their own robot
+  constexpr unsigned int updates_per_thread = 20000u;
+  for( unsigned int thread_count: { 1u, 2u, 4u, 8u } ) {
+    std::vector< std::vector< sharded_t::rect_type > > ranges( thread_count );
+    std::mt19937 rng( 42u );
+    for( unsigned int t = 0u; t != thread_count; ++t ) {
+      // the shards are 256 voxels wide, and the 8 of them inside the 512 voxels a 32bit 3D key can encode go to different threads
+      const auto base_x = ( t & 1u ) * 256u;
+      const auto base_y = ( ( t >> 1u ) & 1u ) * 256u;
+      const auto base_z = ( ( t >> 2u ) & 1u ) * 256u;
+      std::uniform_int_distribution< unsigned int > position( 0u, 240u );
+      std::uniform_int_distribution< unsigned int > size( 1u, 6u );
+      for( unsigned int i = 0u; i != updates_per_thread; ++i ) {
+        const auto x = base_x + position( rng );
+        const auto y = base_y + position( rng );
+        const auto z = base_z + position( rng );
+        ranges[ t ].push_back( sharded_t::rect( sharded_t::enc( x, y, z ), sharded_t::enc( x + size( rng ), y + size( rng ), z + size( rng ) ) ) );
+      }
+    }
+    map_t locked_map;
+    std::mutex mutex;
+    const auto locked_time = measure(
+      [&]() {
+        std::vector< std::thread > threads;
+        for( unsigned int t = 0u; t != thread_count; ++t ) {
+          threads.emplace_back(
+            [&, t]() {
+              for( const auto &range: ranges[ t ] ) {
+                std::lock_guard< std::mutex > lock( mutex );
+                locked_map.update( range, 1u );
+              }
+            }
+          );
+        }
+        for( auto &thread: threads ) thread.join();
+      }
+    );
+    sharded_t sharded;
+    const auto sharded_time = measure(
+      [&]() {
+        std::vector< std::thread > threads;
+        for( unsigned int t = 0u; t != thread_count; ++t ) {
+          threads.emplace_back(
+            [&, t]() {
+              for( const auto &range: ranges[ t ] ) sharded.update( range, 1u );
+            }
+          );
+        }
+        for( auto &thread: threads ) thread.join();
+      }
+    );
+    std::cout << "threads=" << thread_count << " mutex=" << locked_time << "ms sharded=" << sharded_time << "ms (" << locked_map.size() << " " << sharded.size() << ")" << std::endl;
+  }
+}
@@ -0,0 +1,40 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+int main() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  // a monitor reads the occupied volume after every update
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 1000u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 24u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  std::vector< map_t::value_type > updates;
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    updates.emplace_back( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  map_t map;
+  std::size_t checksum = 0u;
+  const auto time = measure(
+    [&]() {
+      for( const auto &[range,v]: updates ) {
+        map.update( range, unsigned( v ) );
+        checksum += map.size();
+      }
+    }
+  );
+  std::cout << "nodes: " << map.nodes().size() << " checksum: " << checksum << " update + size: " << time << "ms" << std::endl;
+}
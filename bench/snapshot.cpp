@@ -0,0 +1,58 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< typename M >
+void run( const char *name ) {
+  // a map published to readers after every small update
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 480u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 16u );
+  M map;
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    map.update( M::rect( M::enc( x, y, z ), M::enc( x + size( rng ), y + size( rng ), z + size( rng ) ) ), 1u );
+  }
+  std::vector< typename M::rect_type > updates;
+  for( unsigned int i = 0u; i != 100u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    updates.push_back( M::rect( M::enc( x, y, z ), M::enc( x + 2u, y + 2u, z + 2u ) ) );
+  }
+  std::size_t size_sum = 0u;
+  const auto update_time = measure(
+    [&]() {
+      for( const auto &range: updates ) map.update( range, 2u );
+    }
+  );
+  const auto snapshot_time = measure(
+    [&]() {
+      for( const auto &range: updates ) {
+        map.update( range, 3u );
+        const auto snapshot = map.snapshot();
+        size_sum += snapshot.size();
+      }
+    }
+  );
+  std::cout << name << " nodes=" << map.nodes().size() << " update=" << update_time << "ms update+snapshot=" << snapshot_time << "ms (" << size_sum << ")" << std::endl;
+}
+
+int main() {
+  run< hdmap::hdmap< std::uint32_t, unsigned int, 3u > >( "standard" );
+  run< hdmap::hdmap< std::uint32_t, unsigned int, 3u, std::equal_to< unsigned int >, hdmap::persistent_underlying_container_t< std::uint32_t, unsigned int, 3u > > >( "persistent" );
+}
@@ -0,0 +1,56 @@
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <hdmap/sparse_voxel_tree.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+template< typename C >
+void run( const char *name, const std::vector< std::uint32_t > &keys, const std::vector< std::uint32_t > &queries ) {
+  C uc;
+  for( const auto &key: keys )
+    hdmap::detail::insert( uc, 1u, key, std::equal_to< unsigned int >{} );
+  std::size_t found_count = 0u;
+  const auto container_time = measure(
+    [&]() {
+      const C &cuc = uc;
+      for( const auto &key: queries ) {
+        hdmap::detail::depth_log_t< std::uint32_t, 2u > log;
+        const auto found = hdmap::detail::find_nearest( cuc, hdmap::detail::get_root_key< std::uint32_t, 2u >(), key, log );
+        if( found != cuc.end() && found->second.is_leaf() && hdmap::detail::contains< std::uint32_t, 2u >( found->second.get_range(), key ) ) ++found_count;
+      }
+    }
+  );
+  const hdmap::sparse_voxel_tree< std::uint32_t, unsigned int, 2u > tree( uc );
+  std::size_t tree_found_count = 0u;
+  const auto tree_time = measure(
+    [&]() {
+      for( const auto &key: queries )
+        if( tree.find( hdmap::key_cast< std::uint64_t, 2u >( key ) ) ) ++tree_found_count;
+    }
+  );
+  std::cout << name << " found: " << found_count << "/" << tree_found_count << " container: " << container_time << "ms sparse_voxel_tree: " << tree_time << "ms" << std::endl;
+}
+
+int main() {
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, 4095u );
+  std::vector< std::uint32_t > keys;
+  for( unsigned int i = 0u; i != 200000u; ++i )
+    keys.push_back( hdmap::detail::to_key< std::uint32_t, 2u >( 0u, dist( rng ), dist( rng ) ) );
+  std::vector< std::uint32_t > queries;
+  for( unsigned int i = 0u; i != 1000000u; ++i )
+    queries.push_back( hdmap::detail::to_key< std::uint32_t, 2u >( 0u, dist( rng ), dist( rng ) ) );
+  run< hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u > >( "standard", keys, queries );
+  run< hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > >( "flat", keys, queries );
+}
@@ -0,0 +1,124 @@
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+
+template< typename F >
+double measure( F &&f ) {
+  const auto begin = std::chrono::high_resolution_clock::now();
+  f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast< std::chrono::duration< double, std::milli > >( end - begin ).count();
+}
+
+// Apply the same ticks with update one by one and with update_batch, and print both times
+template< typename M >
+void compare(
+  const std::string &name,
+  const M &initial,
+  const std::vector< std::vector< typename M::value_type > > &ticks
+) {
+  auto sequential = initial;
+  auto batched = initial;
+  const auto sequential_time = measure(
+    [&]() {
+      for( const auto &tick: ticks )
+        for( const auto &[range,v]: tick )
+          sequential.update( range, unsigned( v ) );
+    }
+  );
+  const auto batched_time = measure(
+    [&]() {
+      for( const auto &tick: ticks )
+        batched.update_batch( tick );
+    }
+  );
+  std::cout << name << " nodes: " << sequential.nodes().size() << "/" << batched.nodes().size() << " update: " << sequential_time << "ms update_batch: " << batched_time << "ms" << std::endl;
+}
+
+// objects moving over a background, every tick clears the old position and writes the new one
+void moving_objects() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 64u, 959u );
+  std::uniform_int_distribution< unsigned int > size( 8u, 32u );
+  std::uniform_int_distribution< int > step( -4, 4 );
+  struct object {
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+  };
+  std::vector< object > objects;
+  for( unsigned int i = 0u; i != 300u; ++i )
+    objects.push_back( object{ position( rng ), position( rng ), size( rng ), size( rng ) } );
+  std::vector< std::vector< map_t::value_type > > ticks( 20u );
+  for( auto &tick: ticks ) {
+    for( unsigned int i = 0u; i != objects.size(); ++i ) {
+      auto &o = objects[ i ];
+      tick.emplace_back( map_t::rect( map_t::enc( o.x, o.y ), map_t::enc( o.x + o.width, o.y + o.height ) ), 0u );
+      o.x += step( rng );
+      o.y += step( rng );
+      tick.emplace_back( map_t::rect( map_t::enc( o.x, o.y ), map_t::enc( o.x + o.width, o.y + o.height ) ), 1u + i % 3u );
+    }
+  }
+  map_t initial;
+  initial.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 1024u, 1024u ) ), 0u );
+  compare( "moving objects", initial, ticks );
+}
+
+// disjoint tiles, nothing in the batch overlaps
+void disjoint_tiles() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 24u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  std::vector< std::vector< map_t::value_type > > ticks( 1u );
+  for( unsigned int y = 0u; y != 64u; ++y )
+    for( unsigned int x = 0u; x != 64u; ++x )
+      ticks[ 0 ].emplace_back( map_t::rect( map_t::enc( x * 32u, y * 32u ), map_t::enc( x * 32u + size( rng ), y * 32u + size( rng ) ) ), value( rng ) );
+  compare( "disjoint tiles", map_t(), ticks );
+}
+
+// random rectangles of any size, overlapping each other partially now and then
+void random_rectangles() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 4095u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 500u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  std::vector< std::vector< map_t::value_type > > ticks( 1u );
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    ticks[ 0 ].emplace_back( map_t::rect( map_t::enc( x, y ), map_t::enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  compare( "random rectangles", map_t(), ticks );
+}
+
+// random boxes in 3D, inside the 512 voxels wide space of a 32bit key
+void random_boxes() {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 411u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 100u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  std::vector< std::vector< map_t::value_type > > ticks( 1u );
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto z = position( rng );
+    ticks[ 0 ].emplace_back( map_t::rect( map_t::enc( x, y, z ), map_t::enc( x + size( rng ), y + size( rng ), z + size( rng ) ) ), value( rng ) );
+  }
+  compare( "random boxes", map_t(), ticks );
+}
+
+int main() {
+  moving_objects();
+  disjoint_tiles();
+  random_rectangles();
+  random_boxes();
+}
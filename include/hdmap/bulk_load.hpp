@@ -0,0 +1,210 @@
+#ifndef HDMAP_BULK_LOAD_HPP
+#define HDMAP_BULK_LOAD_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <hdmap/hdmap.hpp>
+#include <hdmap/overlay.hpp>
+#include <hdmap/dense.hpp>
+#include <hdmap/morton.hpp>
+
+namespace hdmap {
+
+namespace detail {
+
+// The child index of each depth from the root down, packed from the most significant digit, which is the Morton code of the voxel.
+// Sorting the voxels by this visits them in the order of a depth first traversal of the tree.
+template< std::unsigned_integral T, unsigned int dims >
+std::uint64_t get_tree_order( T voxel_key ) {
+  static_assert( get_morton_code_bits< T, dims >() <= 64u, "get_tree_order: The tree is too deep for a 64bit order" );
+  return get_morton_code< T, dims >( voxel_key );
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+unsigned int get_tree_order_digit( std::uint64_t order, unsigned int depth ) {
+  return unsigned( order >> ( depth * dims * 2u ) ) & ( get_max_child_count< dims >() - 1u );
+}
+
+// Fewer voxels than this per thread are loaded on one thread
+constexpr std::size_t bulk_load_chunk_size = 16384u;
+
+// A voxel to load, in tree order
+template< std::unsigned_integral T >
+struct bulk_entry {
+  std::uint64_t order;
+  T key;
+  std::size_t index;
+};
+
+// The node for slot_key made from the sorted voxels inside the slot, inserting its descendants to out.
+// The voxels are split by the child they belong to, and the children are placed as soon as they are complete.
+template< HDMapUnderlyingContainer C, typename V, typename E >
+std::optional< extract_node_type_t< C > > build_from_points(
+  extract_key_type_t< C > slot_key,
+  std::span< const bulk_entry< extract_key_type_t< C > > > entries,
+  std::span< const V > points,
+  C &out,
+  const E &func
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( entries.empty() ) return std::nullopt;
+  // a lone voxel ends up as a leaf moved up to the slot anyway
+  if( entries.size() == 1u ) return N( entries.front().key, U( points[ entries.front().index ].second ) );
+  const auto depth = get_depth< T, dims >( slot_key );
+  std::array< std::optional< N >, get_max_child_count< dims >() > children;
+  const auto first_child_key = get_key_in_depth< T, dims >( depth - 1u, slot_key );
+  for( auto begin = entries.begin(); begin != entries.end(); ) {
+    const auto index = get_tree_order_digit< T, dims >( begin->order, depth - 1u );
+    auto end = std::next( begin );
+    while( end != entries.end() && get_tree_order_digit< T, dims >( end->order, depth - 1u ) == index ) ++end;
+    children[ index ] = build_from_points( child_index_to_key< T, dims >( first_child_key, index ), std::span< const bulk_entry< T > >( begin, end ), points, out, func );
+    begin = end;
+  }
+  return place_children( children, slot_key, out, func );
+}
+
+// The node for slot_key, taking the subtrees at depth task_depth from tasks in tree order
+template< HDMapUnderlyingContainer C, typename E >
+std::optional< extract_node_type_t< C > > assemble_subtrees(
+  extract_key_type_t< C > slot_key,
+  std::span< const std::pair< extract_key_type_t< C >, std::size_t > > task_keys,
+  std::vector< std::optional< extract_node_type_t< C > > > &tasks,
+  std::size_t first_task,
+  unsigned int task_depth,
+  C &out,
+  const E &func
+) {
+  using T = extract_key_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto depth = get_depth< T, dims >( slot_key );
+  if( depth == task_depth ) return std::move( tasks[ first_task ] );
+  std::array< std::optional< N >, get_max_child_count< dims >() > children;
+  for( std::size_t begin = 0u; begin != task_keys.size(); ) {
+    const auto child_key = get_key_in_depth< T, dims >( depth - 1u, task_keys[ begin ].first );
+    auto end = begin + 1u;
+    while( end != task_keys.size() && get_key_in_depth< T, dims >( depth - 1u, task_keys[ end ].first ) == child_key ) ++end;
+    children[ key_to_child_index< T, dims >( child_key ) ] = assemble_subtrees( child_key, task_keys.subspan( begin, end - begin ), tasks, first_task + begin, task_depth, out, func );
+    begin = end;
+  }
+  return place_children( children, slot_key, out, func );
+}
+
+}
+
+// Make a map of the voxels in points, each given as the key of the voxel made by enc and its value.
+// If a voxel appears more than once, the last value is used, so the result is the same as updating each voxel in turn.
+// The voxels are sorted in the order of a depth first traversal of the tree, and each node is made once when all voxels under it are known.
+// The sort and the subtrees are split over thread_count threads.
+template< HDMap M >
+M build_from_points(
+  std::span< const std::pair< typename M::key_type, typename M::mapped_type > > points,
+  unsigned int thread_count = std::thread::hardware_concurrency()
+) {
+  using C = std::remove_cvref_t< decltype( std::declval< const M& >().nodes() ) >;
+  using T = detail::extract_key_type_t< C >;
+  using N = detail::extract_node_type_t< C >;
+  using E = decltype( std::declval< const M& >().value_eq() );
+  constexpr auto dims = detail::hdmap_dims_v< M >;
+  constexpr auto root_key = detail::get_root_key< T, dims >();
+  if( thread_count == 0u ) thread_count = 1u;
+  E equal_to{};
+  std::vector< detail::bulk_entry< T > > entries( points.size() );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      if( detail::get_component< typename M::key_type, dims >( j, points[ i ].first ) > typename M::key_type( detail::get_component_max< T, dims >() ) )
+        throw std::out_of_range( "build_from_points: The component value is higher than the key format can encode." );
+    }
+    const auto key = key_cast< T, dims >( points[ i ].first );
+    entries[ i ] = detail::bulk_entry< T >{ detail::get_tree_order< T, dims >( key ), key, i };
+  }
+  // the index breaks ties, so that the last of the duplicated voxels comes last
+  const auto less = []( const auto &l, const auto &r ) {
+    return l.order != r.order ? l.order < r.order : l.index < r.index;
+  };
+  const auto chunk_count = std::min< std::size_t >( thread_count, std::max< std::size_t >( entries.size() / detail::bulk_load_chunk_size, 1u ) );
+  if( chunk_count > 1u ) {
+    std::vector< std::size_t > bounds;
+    for( std::size_t i = 0u; i <= chunk_count; ++i ) bounds.push_back( entries.size() * i / chunk_count );
+    std::vector< std::thread > threads;
+    for( std::size_t i = 1u; i < chunk_count; ++i )
+      threads.emplace_back( [&, i]() { std::sort( std::next( entries.begin(), bounds[ i ] ), std::next( entries.begin(), bounds[ i + 1u ] ), less ); } );
+    std::sort( entries.begin(), std::next( entries.begin(), bounds[ 1u ] ), less );
+    for( auto &thread: threads ) thread.join();
+    // merge the sorted chunks pairwise, doubling the width each round
+    for( std::size_t width = 1u; width < chunk_count; width *= 2u ) {
+      threads.clear();
+      for( std::size_t i = 0u; i + width < chunk_count; i += width * 2u ) {
+        threads.emplace_back(
+          [&, i, width]() {
+            std::inplace_merge(
+              std::next( entries.begin(), bounds[ i ] ),
+              std::next( entries.begin(), bounds[ i + width ] ),
+              std::next( entries.begin(), bounds[ std::min( i + width * 2u, chunk_count ) ] ),
+              less
+            );
+          }
+        );
+      }
+      for( auto &thread: threads ) thread.join();
+    }
+  }
+  else std::sort( entries.begin(), entries.end(), less );
+  // keep the last of each voxel, which unique over the reversed order leaves at the end
+  entries.erase(
+    entries.begin(),
+    std::unique(
+      entries.rbegin(),
+      entries.rend(),
+      []( const auto &l, const auto &r ) { return l.order == r.order; }
+    ).base()
+  );
+  C out;
+  // a tree with n leaves has less than n internal nodes
+  if constexpr ( requires { out.reserve( std::size_t( 0u ) ); } ) out.reserve( entries.size() * 2u );
+  std::optional< N > root_node;
+  // split the voxels at the shallowest depth giving several subtrees to each thread
+  unsigned int task_depth = detail::get_depth< T, dims >( root_key );
+  std::vector< std::pair< T, std::size_t > > task_keys;
+  if( thread_count > 1u && entries.size() >= detail::bulk_load_chunk_size * 2u ) {
+    while( task_depth > 1u && task_keys.size() < thread_count * 4u ) {
+      --task_depth;
+      task_keys.clear();
+      for( std::size_t i = 0u; i != entries.size(); ++i ) {
+        const auto key = detail::get_key_in_depth< T, dims >( task_depth, entries[ i ].key );
+        if( task_keys.empty() || task_keys.back().first != key ) task_keys.emplace_back( key, i );
+      }
+    }
+  }
+  const std::span< const detail::bulk_entry< T > > sorted( entries );
+  if( task_keys.size() > 1u ) {
+    auto tasks = detail::build_subtrees(
+      task_keys.size(),
+      thread_count,
+      out,
+      [&]( std::size_t i, C &part ) {
+        const auto end = i + 1u == task_keys.size() ? sorted.size() : task_keys[ i + 1u ].second;
+        return detail::build_from_points( task_keys[ i ].first, sorted.subspan( task_keys[ i ].second, end - task_keys[ i ].second ), points, part, equal_to );
+      }
+    );
+    root_node = detail::assemble_subtrees( root_key, std::span< const std::pair< T, std::size_t > >( task_keys ), tasks, 0u, task_depth, out, equal_to );
+  }
+  else root_node = detail::build_from_points( root_key, sorted, points, out, equal_to );
+  if( root_node ) out.insert( std::make_pair( root_key, std::move( *root_node ) ) );
+  return M( E( equal_to ), std::move( out ) );
+}
+
+}
+#endif
+
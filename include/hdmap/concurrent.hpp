@@ -0,0 +1,135 @@
+#ifndef HDMAP_CONCURRENT_HPP
+#define HDMAP_CONCURRENT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <hdmap/hdmap.hpp>
+
+namespace hdmap {
+
+// A map modified by one writer thread and read by any number of reader threads without locks.
+// Each modification is published to the readers as a snapshot of the map, so a reader sees either all or none of a call to write.
+// A snapshot is deleted by the writer once no reader can still be reading it ( epoch based reclamation ).
+// Publishing copies the map with hdmap::snapshot, which takes constant time only if M uses persistent_underlying_container_t.
+template< HDMap M >
+class concurrent_hdmap {
+  struct alignas( 64 ) reader_slot {
+    std::atomic< bool > claimed = false;
+    // the epoch the reader entered, or 0 if the reader is not reading
+    std::atomic< std::uint64_t > epoch = 0u;
+  };
+  struct retired_snapshot {
+    std::unique_ptr< const M > snapshot;
+    std::uint64_t epoch;
+  };
+public:
+  using map_type = M;
+  // A reader thread's registration. Each reader thread needs its own.
+  class reader {
+  public:
+    reader( const reader& ) = delete;
+    reader( reader &&r ) noexcept : slot( std::exchange( r.slot, nullptr ) ), parent( r.parent ) {}
+    reader &operator=( const reader& ) = delete;
+    ~reader() {
+      if( slot ) slot->claimed.store( false, std::memory_order_release );
+    }
+    // Call f with the latest published snapshot. The snapshot must not be used after f returns.
+    // f may call read again, and the snapshots of the outer calls stay alive until those calls return.
+    template< std::invocable< const M& > F >
+    decltype( auto ) read( F &&f ) const {
+      // only this reader writes the slot
+      const auto entered = slot->epoch.load( std::memory_order_relaxed );
+      struct leave {
+        ~leave() {
+          slot->epoch.store( entered, std::memory_order_release );
+        }
+        reader_slot *slot;
+        std::uint64_t entered;
+      } guard{ slot, entered };
+      // a nested read keeps the epoch of the outermost one, which is older and so protects every snapshot loaded since
+      if( entered == 0u ) slot->epoch.store( parent->epoch.load() );
+      return std::forward< F >( f )( *parent->current.load() );
+    }
+  private:
+    friend class concurrent_hdmap;
+    reader( reader_slot *slot_, const concurrent_hdmap *parent_ ) : slot( slot_ ), parent( parent_ ) {}
+    reader_slot *slot;
+    const concurrent_hdmap *parent;
+  };
+  explicit concurrent_hdmap(
+    M &&initial = M(),
+    std::size_t max_readers = 64u
+  ) :
+    map( std::move( initial ) ),
+    slots( max_readers ),
+    current( new M( map.snapshot() ) ) {}
+  concurrent_hdmap( const concurrent_hdmap& ) = delete;
+  concurrent_hdmap &operator=( const concurrent_hdmap& ) = delete;
+  // All readers have to be destroyed before the map
+  ~concurrent_hdmap() {
+    delete current.load();
+  }
+  // Throws std::length_error if max_readers readers already exist.
+  // Can be called from any thread.
+  reader get_reader() const {
+    for( auto &slot: slots ) {
+      bool expected = false;
+      if( slot.claimed.compare_exchange_strong( expected, true, std::memory_order_acquire ) )
+        return reader( &slot, this );
+    }
+    throw std::length_error( "concurrent_hdmap: The number of readers exceeds max_readers." );
+  }
+  // The functions below must be called from the writer thread only.
+  // Call f with the map and publish the result.
+  template< std::invocable< M& > F >
+  void write( F &&f ) {
+    std::forward< F >( f )( map );
+    publish();
+  }
+  auto update( const typename M::rect_type &range, typename M::mapped_type &&value ) {
+    const auto updated = map.update( range, std::move( value ) );
+    publish();
+    return updated;
+  }
+  auto erase( const typename M::rect_type &range ) {
+    const auto erased = map.erase( range );
+    publish();
+    return erased;
+  }
+  // The writer's map, which always has the latest modifications
+  const M &get() const {
+    return map;
+  }
+  // Delete the snapshots no reader is reading.
+  // This is done on each publish, so calling this is only needed to release the memory when the writer becomes idle.
+  void reclaim() {
+    std::uint64_t oldest = epoch.load();
+    for( const auto &slot: slots ) {
+      const auto entered = slot.epoch.load();
+      if( entered != 0u && entered < oldest ) oldest = entered;
+    }
+    // a reader which entered in epoch e has loaded a snapshot retired in e or later
+    std::erase_if( retired, [&]( const auto &v ) { return v.epoch < oldest; } );
+  }
+private:
+  void publish() {
+    const auto old = current.exchange( new M( map.snapshot() ) );
+    retired.push_back( retired_snapshot{ std::unique_ptr< const M >( old ), epoch.fetch_add( 1u ) } );
+    reclaim();
+  }
+  M map;
+  mutable std::vector< reader_slot > slots;
+  std::atomic< const M* > current;
+  std::atomic< std::uint64_t > epoch = 1u;
+  std::vector< retired_snapshot > retired;
+};
+
+}
+#endif
+
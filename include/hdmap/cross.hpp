@@ -1,7 +1,9 @@
 #ifndef HDMAP_CROSS_HPP
 #define HDMAP_CROSS_HPP
 
+#include <tuple>
 #include <hdmap/hdmap.hpp>
+#include <hdmap/overlay.hpp>
 
 namespace hdmap {
 
@@ -36,25 +38,37 @@ auto make_tuple_eq( Eq ...eq ) {
   return tuple_eq< Eq... >( eq... );
 }
 
-template<
-  HDMap T,
-  HDMap U
->
-struct cross_result;
+// The maps crossed at once share the key type, and the result holds a tuple of their values
+template< HDMap ...M >
+struct cross_result {
+  using container_type = std::remove_cvref_t< decltype( std::declval< const std::tuple_element_t< 0u, std::tuple< M... > >& >().nodes() ) >;
+  using key_type = detail::extract_key_type_t< container_type >;
+  constexpr static auto dims = detail::extract_dims_v< container_type >;
+  using mapped_type = std::tuple< typename M::mapped_type... >;
+  using type = hdmap<
+    key_type,
+    mapped_type,
+    dims,
+    tuple_eq< decltype( std::declval< const M& >().value_eq() )... >,
+    standard_underlying_container_t< key_type, mapped_type, dims >
+  >;
+};
 template<
   std::unsigned_integral LT,
   typename LU,
   std::regular_invocable< const LU&, const LU& > LEq,
   HDMapUnderlyingContainer LC,
+  typename LA,
   std::unsigned_integral RT,
   typename RU,
   std::regular_invocable< const RU&, const RU& > REq,
   HDMapUnderlyingContainer RC,
+  typename RA,
   unsigned int dims
 >
 struct cross_result<
-  hdmap< LT, LU, dims, LEq, LC >,
-  hdmap< RT, RU, dims, REq, RC >
+  hdmap< LT, LU, dims, LEq, LC, LA >,
+  hdmap< RT, RU, dims, REq, RC, RA >
 > {
   using type = hdmap<
     std::common_type_t< LT, RT >,
@@ -65,22 +79,205 @@ struct cross_result<
   >;
 };
 
-template< HDMap T, HDMap U >
-using cross_result_t = typename cross_result< T, U >::type;
+template< HDMap ...M >
+using cross_result_t = typename cross_result< M... >::type;
 
+namespace detail {
+
+// Move range by to - from, clamping the components to the domain of L
+template< std::unsigned_integral L, unsigned int dims >
+rectangle< L, dims > move_rectangle(
+  const rectangle< L, dims > &range,
+  L from,
+  L to
+) {
+  constexpr L limit = get_component_max< L, dims >();
+  const auto move = [&]( unsigned int i, L v ) {
+    v += get_component< L, dims >( i, to );
+    const auto offset = get_component< L, dims >( i, from );
+    return v < offset ? L( 0u ) : std::min( L( v - offset ), limit );
+  };
+  rectangle< L, dims > moved;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    set_component< L, dims >( i, moved.left_top, move( i, get_component< L, dims >( i, range.left_top ) ) );
+    set_component< L, dims >( i, moved.right_bottom, move( i, get_component< L, dims >( i, range.right_bottom ) ) );
+  }
+  return moved;
+}
+
+// Call func( intersection, lvalue, rvalue ) for each pair of overlapping leaves of two maps by descending both trees at once.
+// The left ranges are clipped to lclip and moved by to - from before they are compared with the right ranges.
+// The node with the larger range is split first, and only its children overlapping the other node are visited.
+// lkey and rkey are the ranges the nodes stand for, which are the child slots for the children of an inherited node holding the inherited value.
+template< std::unsigned_integral L, unsigned int dims, HDMapUnderlyingContainer LC, HDMapUnderlyingContainer RC, typename F >
+void cross_nodes(
+  const LC &lmap,
+  const extract_node_type_t< LC > &lnode,
+  extract_key_type_t< LC > lkey,
+  const RC &rmap,
+  const extract_node_type_t< RC > &rnode,
+  extract_key_type_t< RC > rkey,
+  const rectangle< L, dims > &lclip,
+  L from,
+  L to,
+  F &func
+) {
+  using LT = extract_key_type_t< LC >;
+  using RT = extract_key_type_t< RC >;
+  const auto lrange = to_rectangle< L, dims >( lkey );
+  if( get_overlap_count( lrange, lclip ) == 0u ) return;
+  const auto clipped = lrange & lclip;
+  const auto moved = move_rectangle( clipped, from, to );
+  const auto rrange = to_rectangle< L, dims >( rkey );
+  if( get_overlap_count( moved, rrange ) == 0u ) return;
+  const bool lleaf = covers( lnode, lkey );
+  const bool rleaf = covers( rnode, rkey );
+  if( lleaf && rleaf ) {
+    func( moved & rrange, lnode.get_data(), rnode.get_data() );
+    return;
+  }
+  if( !lleaf && ( rleaf || get_depth< LT, dims >( lkey ) >= get_depth< RT, dims >( rkey ) ) ) {
+    const auto target = move_rectangle( rrange, to, from );
+    if( get_overlap_count( target, clipped ) == 0u ) return;
+    for_each_overlapping_child< LT, dims >(
+      lnode.get_range(),
+      target & clipped,
+      [&]( LT child_key, bool ) {
+        if( lnode.has_inherited_child( child_key ) ) {
+          cross_nodes( lmap, lnode, child_key, rmap, rnode, rkey, lclip, from, to, func );
+          return true;
+        }
+        if( !lnode.has_child( child_key ) ) return true;
+        const auto child_node = lmap.find( child_key );
+        assert( child_node != lmap.end() );
+        cross_nodes( lmap, child_node->second, child_node->second.get_range(), rmap, rnode, rkey, lclip, from, to, func );
+        return true;
+      }
+    );
+  }
+  else {
+    for_each_overlapping_child< RT, dims >(
+      rnode.get_range(),
+      moved,
+      [&]( RT child_key, bool ) {
+        if( rnode.has_inherited_child( child_key ) ) {
+          cross_nodes( lmap, lnode, lkey, rmap, rnode, child_key, lclip, from, to, func );
+          return true;
+        }
+        if( !rnode.has_child( child_key ) ) return true;
+        const auto child_node = rmap.find( child_key );
+        assert( child_node != rmap.end() );
+        cross_nodes( lmap, lnode, lkey, rmap, child_node->second, child_node->second.get_range(), lclip, from, to, func );
+        return true;
+      }
+    );
+  }
+}
+
+template< std::unsigned_integral L, unsigned int dims, HDMapUnderlyingContainer LC, HDMapUnderlyingContainer RC, typename F >
+void cross_nodes(
+  const LC &lmap,
+  const RC &rmap,
+  const rectangle< L, dims > &lclip,
+  L from,
+  L to,
+  F &&func
+) {
+  const auto lroot = lmap.find( get_root_key< extract_key_type_t< LC >, dims >() );
+  if( lroot == lmap.end() ) return;
+  const auto rroot = rmap.find( get_root_key< extract_key_type_t< RC >, dims >() );
+  if( rroot == rmap.end() ) return;
+  cross_nodes( lmap, lroot->second, lroot->second.get_range(), rmap, rroot->second, rroot->second.get_range(), lclip, from, to, func );
+}
+
+// Combine the nodes of every map standing for slot_key into out, returning the node for slot_key or nullopt if the slot is empty.
+// A slot empty in one of the maps is skipped as a whole, and a slot covered by a leaf or an inherited child in every map becomes a leaf.
+template< HDMapUnderlyingContainer Out, typename E, HDMapUnderlyingContainer ...C >
+std::optional< extract_node_type_t< Out > > cross_slot(
+  const std::tuple< const C&... > &maps,
+  const std::tuple< const extract_node_type_t< C >*... > &nodes,
+  extract_key_type_t< Out > slot_key,
+  Out &out,
+  const E &func
+) {
+  using T = extract_key_type_t< Out >;
+  using U = extract_value_type_t< Out >;
+  using N = extract_node_type_t< Out >;
+  constexpr auto dims = extract_dims_v< Out >;
+  const bool empty = std::apply( []( const auto *...n ) { return ( !n || ... ); }, nodes );
+  if( empty ) return std::nullopt;
+  const bool covered = std::apply(
+    [&]( const auto *...n ) {
+      return ( covers( *n, slot_key ) && ... );
+    },
+    nodes
+  );
+  if( covered ) return std::apply( [&]( const auto *...n ) { return N( slot_key, U( n->get_data()... ) ); }, nodes );
+  std::array< std::optional< N >, get_max_child_count< dims >() > children;
+  const auto first_child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( slot_key ) - 1u, slot_key );
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    const auto child_key = child_index_to_key< T, dims >( first_child_key, i );
+    const auto child_nodes = [&]< std::size_t ...I >( std::index_sequence< I... > ) {
+      return std::make_tuple( get_overlay_child( std::get< I >( maps ), std::get< I >( nodes ), slot_key, child_key )... );
+    }( std::index_sequence_for< C... >{} );
+    children[ i ] = cross_slot( maps, child_nodes, child_key, out, func );
+  }
+  return place_children( children, slot_key, out, func );
+}
+
+// Cross maps sharing the key type by walking their slots together
+template< HDMap Out, HDMap ...M >
+Out cross_aligned( const M &...maps ) {
+  using C = std::remove_cvref_t< decltype( std::declval< const Out& >().nodes() ) >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  static_assert(
+    ( std::is_same_v< extract_key_type_t< std::remove_cvref_t< decltype( maps.nodes() ) > >, T > && ... ),
+    "the maps crossed at once must have the same key type"
+  );
+  constexpr auto root_key = get_root_key< T, dims >();
+  const auto get_root = [&]( const auto &map ) -> const extract_node_type_t< std::remove_cvref_t< decltype( map.nodes() ) > >* {
+    const auto root_node = map.nodes().find( root_key );
+    return root_node != map.nodes().end() ? &root_node->second : nullptr;
+  };
+  auto func = make_tuple_eq( maps.value_eq()... );
+  C out;
+  auto root_node = cross_slot(
+    std::tie( maps.nodes()... ),
+    std::make_tuple( get_root( maps )... ),
+    root_key,
+    out,
+    func
+  );
+  if( root_node ) out.insert( std::make_pair( root_key, std::move( *root_node ) ) );
+  return Out( std::move( func ), std::move( out ) );
+}
+
+}
+
+// Maps with the same key type are crossed slot by slot, others by descending both trees
 template< HDMap T, HDMap U >
 auto cross( const T &l, const U &r ) {
-  cross_result_t< T, U > out( make_tuple_eq( l.value_eq(), r.value_eq() ) );
-  std::vector< typename U::value_type > temp;
-  for( const auto &[lkey,lvalue]: l.leaves() ) {
-    temp.clear();
-    r.find( lkey, temp );
-    for( const auto &[rkey,rvalue]: temp ) {
-      out.update( rkey, std::make_pair( lvalue, rvalue ) );
+  using out_t = cross_result_t< T, U >;
+  using L = detail::extract_key_type_t< typename out_t::rect_type >;
+  constexpr static auto dims = detail::extract_dims_v< typename out_t::rect_type >;
+  using LT = detail::extract_key_type_t< std::remove_cvref_t< decltype( l.nodes() ) > >;
+  using RT = detail::extract_key_type_t< std::remove_cvref_t< decltype( r.nodes() ) > >;
+  if constexpr ( std::is_same_v< LT, RT > ) return detail::cross_aligned< out_t >( l, r );
+  out_t out( make_tuple_eq( l.value_eq(), r.value_eq() ) );
+  detail::cross_nodes(
+    l.nodes(),
+    r.nodes(),
+    detail::to_rectangle< L, dims >( detail::get_root_key< LT, dims >() ),
+    L( 0u ),
+    L( 0u ),
+    [&]( const auto &range, const auto &lvalue, const auto &rvalue ) {
+      out.update( range, std::make_pair( lvalue, rvalue ) );
     }
-  }
+  );
   return out;
 }
+// The part of l inside lrect is moved onto rrect, and the result is in the coordinates relative to rrect
 template< HDMap M >
 auto cross(
   const M &l,
@@ -89,30 +286,32 @@ auto cross(
   const typename M::rect_type &rrect
 ) {
   using T = detail::extract_key_type_t< typename M::rect_type >;
-  constexpr static auto dims = detail::extract_dims_v< typename M::rect_type >;
+  [[maybe_unused]] constexpr static auto dims = detail::extract_dims_v< typename M::rect_type >;
   cross_result_t< M, M > out( make_tuple_eq( l.value_eq(), r.value_eq() ) );
-  std::vector< typename M::value_type > l_temp;
-  std::vector< typename M::value_type > r_temp;
-  l.find( lrect, l_temp );
-  auto diff = detail::sub_key< T, dims >( rrect.left_top, lrect.left_top );
-  for( const auto &[lkey,lvalue]: l_temp ) {
-    const typename M::rect_type shifted_lrect{
-      detail::add_key< T, dims >( lkey.left_top, diff ),
-      detail::add_key< T, dims >( lkey.right_bottom, diff )
-    };
-    r_temp.clear();
-    r.find( shifted_lrect, r_temp );
-    for( const auto &[rkey,rvalue]: r_temp ) {
-      const typename M::rect_type shifted_rrect{
-        detail::sub_key< T, dims >( rkey.left_top, rrect.left_top ),
-        detail::sub_key< T, dims >( rkey.right_bottom, rrect.left_top )
+  detail::cross_nodes(
+    l.nodes(),
+    r.nodes(),
+    lrect,
+    lrect.left_top,
+    rrect.left_top,
+    [&]( const auto &range, const auto &lvalue, const auto &rvalue ) {
+      const typename M::rect_type shifted{
+        detail::sub_key< T, dims >( range.left_top, rrect.left_top ),
+        detail::sub_key< T, dims >( range.right_bottom, rrect.left_top )
       };
-      out.update( shifted_rrect, std::make_pair( lvalue, rvalue ) );
+      out.update( shifted, std::make_pair( lvalue, rvalue ) );
     }
-  }
+  );
   return out;
 }
 
+// Cross three or more maps with the same key type in one walk over all of them.
+// Each node of the result is built once, bottom-up, and inserted without intermediate maps.
+template< HDMap M1, HDMap M2, HDMap M3, HDMap ...Ms >
+auto cross( const M1 &m1, const M2 &m2, const M3 &m3, const Ms &...ms ) {
+  return detail::cross_aligned< cross_result_t< M1, M2, M3, Ms... > >( m1, m2, m3, ms... );
+}
+
 }
 #endif
 
@@ -0,0 +1,220 @@
+#ifndef HDMAP_DENSE_HPP
+#define HDMAP_DENSE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <hdmap/hdmap.hpp>
+#include <hdmap/overlay.hpp>
+
+namespace hdmap {
+
+namespace detail {
+
+template< HDMap M >
+constexpr unsigned int hdmap_dims_v = extract_dims_v< std::remove_cvref_t< decltype( std::declval< const M& >().nodes() ) > >;
+
+// Build task_count subtrees on thread_count threads and move all of their descendants to out.
+// build( i, part ) returns the node of the i-th subtree, inserting its descendants to part, which is a container for the i-th subtree only.
+template< HDMapUnderlyingContainer C, typename F >
+std::vector< std::optional< extract_node_type_t< C > > > build_subtrees(
+  std::size_t task_count,
+  unsigned int thread_count,
+  C &out,
+  const F &build
+) {
+  std::vector< std::optional< extract_node_type_t< C > > > tasks( task_count );
+  std::vector< C > parts( task_count );
+  std::atomic< std::size_t > next_task( 0u );
+  const auto worker = [&]() {
+    for( auto i = next_task++; i < task_count; i = next_task++ ) tasks[ i ] = build( i, parts[ i ] );
+  };
+  std::vector< std::thread > threads;
+  for( unsigned int i = 1u; i < thread_count; ++i ) threads.emplace_back( worker );
+  worker();
+  for( auto &thread: threads ) thread.join();
+  std::size_t total = 0u;
+  for( const auto &part: parts ) total += part.size();
+  if constexpr ( requires { out.reserve( std::size_t( 0u ) ); } ) out.reserve( out.size() + total + task_count * 2u );
+  for( auto &part: parts ) {
+    if constexpr ( requires { out.merge( part ); } ) out.merge( part );
+    else {
+      for( auto &v: part ) out.insert( std::make_pair( v.first, std::move( v.second ) ) );
+    }
+  }
+  return tasks;
+}
+
+// A dense raster of voxels starting at the origin.
+// The voxel ( x0, x1, ... ) is data[ x0 * strides[ 0 ] + x1 * strides[ 1 ] + ... ], and the voxels equal to empty are left empty.
+template< typename U, unsigned int dims, typename E >
+struct dense_source {
+  std::array< std::size_t, dims > extent;
+  const U *data;
+  std::array< std::size_t, dims > strides;
+  const std::optional< U > &empty;
+  const E &func;
+};
+
+template< std::unsigned_integral T, unsigned int dims, typename U, typename E >
+bool overlaps_dense( T slot_key, const dense_source< U, dims, E > &source ) {
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    if( get_component< T, dims >( i, slot_key ) >= source.extent[ i ] ) return false;
+  }
+  return true;
+}
+
+// The node of the voxels in the depth 1 slot slot_key, inserting its children to out.
+// Most blocks of a raster are uniform, so that is checked before the children are made.
+template< HDMapUnderlyingContainer C, typename E >
+std::optional< extract_node_type_t< C > > build_block(
+  extract_key_type_t< C > slot_key,
+  const dense_source< extract_value_type_t< C >, extract_dims_v< C >, E > &source,
+  C &out
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  constexpr auto child_count = get_max_child_count< dims >();
+  std::array< const U*, child_count > values;
+  bool uniform = true;
+  for( unsigned int i = 0u; i != child_count; ++i ) {
+    std::size_t offset = 0u;
+    values[ i ] = nullptr;
+    bool inside = true;
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      const std::size_t position = std::size_t( get_component< T, dims >( j, slot_key ) ) + ( ( i >> ( j * 2u ) ) & 0x3u );
+      if( position >= source.extent[ j ] ) inside = false;
+      offset += position * source.strides[ j ];
+    }
+    if( inside ) {
+      values[ i ] = source.data + offset;
+      if( source.empty && source.func( *values[ i ], *source.empty ) ) values[ i ] = nullptr;
+    }
+    uniform = uniform && values[ i ] && source.func( *values[ i ], *values[ 0 ] );
+  }
+  if( uniform ) return N( slot_key, U( *values[ 0 ] ) );
+  std::array< std::optional< N >, child_count > children;
+  const auto first_child_key = get_key_in_depth< T, dims >( 0u, slot_key );
+  for( unsigned int i = 0u; i != child_count; ++i ) {
+    if( values[ i ] ) children[ i ] = N( child_index_to_key< T, dims >( first_child_key, i ), U( *values[ i ] ) );
+  }
+  return place_children( children, slot_key, out, source.func );
+}
+
+// The node for slot_key built from the raster, inserting its descendants to out.
+// The slots at depth task_depth are not built but taken from tasks in the order they are visited, if tasks is not nullptr.
+template< HDMapUnderlyingContainer C, typename E >
+std::optional< extract_node_type_t< C > > build_from_dense(
+  extract_key_type_t< C > slot_key,
+  const dense_source< extract_value_type_t< C >, extract_dims_v< C >, E > &source,
+  C &out,
+  unsigned int task_depth,
+  std::vector< std::optional< extract_node_type_t< C > > > *tasks,
+  std::size_t &task_index
+) {
+  using T = extract_key_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto depth = get_depth< T, dims >( slot_key );
+  if( tasks && depth == task_depth ) return std::move( ( *tasks )[ task_index++ ] );
+  if( depth == 1u ) return build_block( slot_key, source, out );
+  std::array< std::optional< N >, get_max_child_count< dims >() > children;
+  const auto first_child_key = get_key_in_depth< T, dims >( depth - 1u, slot_key );
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    const auto child_key = child_index_to_key< T, dims >( first_child_key, i );
+    if( overlaps_dense( child_key, source ) )
+      children[ i ] = build_from_dense( child_key, source, out, task_depth, tasks, task_index );
+  }
+  return place_children( children, slot_key, out, source.func );
+}
+
+// Append the slots at depth task_depth overlapping the raster to dest, in the order build_from_dense visits them
+template< std::unsigned_integral T, unsigned int dims, typename U, typename E >
+void get_dense_tasks(
+  T slot_key,
+  const dense_source< U, dims, E > &source,
+  unsigned int task_depth,
+  std::vector< T > &dest
+) {
+  const auto depth = get_depth< T, dims >( slot_key );
+  if( depth == task_depth ) {
+    dest.push_back( slot_key );
+    return;
+  }
+  const auto first_child_key = get_key_in_depth< T, dims >( depth - 1u, slot_key );
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    const auto child_key = child_index_to_key< T, dims >( first_child_key, i );
+    if( overlaps_dense( child_key, source ) ) get_dense_tasks( child_key, source, task_depth, dest );
+  }
+}
+
+}
+
+// Make a map of the voxels of a dense raster starting at the origin.
+// The voxel ( x0, x1, ... ) is data[ x0 * strides[ 0 ] + x1 * strides[ 1 ] + ... ] for xi < extent[ i ], and the voxels equal to empty are left empty.
+// The tree is built bottom up, so each node is made once in its final shape instead of being split and merged by update.
+// The subtrees are built on thread_count threads, and the result is the same as updating each voxel in turn.
+template< HDMap M >
+M build_from_dense(
+  const std::array< std::size_t, detail::hdmap_dims_v< M > > &extent,
+  const typename M::mapped_type *data,
+  const std::array< std::size_t, detail::hdmap_dims_v< M > > &strides,
+  const std::optional< typename M::mapped_type > &empty = std::nullopt,
+  unsigned int thread_count = std::thread::hardware_concurrency()
+) {
+  using C = std::remove_cvref_t< decltype( std::declval< const M& >().nodes() ) >;
+  using T = detail::extract_key_type_t< C >;
+  using N = detail::extract_node_type_t< C >;
+  constexpr auto dims = detail::hdmap_dims_v< M >;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    if( extent[ i ] > std::size_t( detail::get_component_max< T, dims >() ) + 1u )
+      throw std::out_of_range( "build_from_dense: The extent is larger than the key format can encode." );
+  }
+  using E = decltype( std::declval< const M& >().value_eq() );
+  E equal_to{};
+  const detail::dense_source< typename M::mapped_type, dims, E > source{ extent, data, strides, empty, equal_to };
+  constexpr auto root_key = detail::get_root_key< T, dims >();
+  C out;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    if( extent[ i ] == 0u ) return M( E( equal_to ), std::move( out ) );
+  }
+  // split at the shallowest depth giving several subtrees to each thread, as a raster is often smaller than a top level subtree
+  if( thread_count == 0u ) thread_count = 1u;
+  unsigned int task_depth = detail::get_depth< T, dims >( root_key );
+  std::vector< T > task_keys;
+  if( thread_count > 1u ) {
+    while( task_depth > 2u && task_keys.size() < thread_count * 4u ) {
+      --task_depth;
+      task_keys.clear();
+      detail::get_dense_tasks( root_key, source, task_depth, task_keys );
+    }
+  }
+  std::vector< std::optional< N > > tasks;
+  std::size_t task_index = 0u;
+  if( task_keys.size() > 1u ) {
+    tasks = detail::build_subtrees(
+      task_keys.size(),
+      thread_count,
+      out,
+      [&]( std::size_t i, C &part ) {
+        std::size_t unused = 0u;
+        return detail::build_from_dense( task_keys[ i ], source, part, 0u, nullptr, unused );
+      }
+    );
+  }
+  auto root_node = detail::build_from_dense( root_key, source, out, task_depth, tasks.empty() ? nullptr : &tasks, task_index );
+  if( root_node ) out.insert( std::make_pair( root_key, std::move( *root_node ) ) );
+  return M( E( equal_to ), std::move( out ) );
+}
+
+}
+#endif
+
@@ -0,0 +1,371 @@
+#ifndef HDMAP_FLAT_CONTAINER_HPP
+#define HDMAP_FLAT_CONTAINER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <bit>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <hdmap/hdmap.hpp>
+
+namespace hdmap {
+
+template< std::unsigned_integral T, unsigned int dims >
+struct key_hash {
+  std::size_t operator()( T v ) const {
+    // the key is a set of narrow bit fields ( components and depth ), so every
+    // input bit has to reach the low bits used as the bucket index
+    std::uint64_t x = std::uint64_t( v );
+    x ^= x >> 30u;
+    x *= 0xbf58476d1ce4e5b9u;
+    x ^= x >> 27u;
+    x *= 0x94d049bb133111ebu;
+    x ^= x >> 31u;
+    return std::size_t( x );
+  }
+};
+
+namespace detail {
+
+enum class slot_state_t : std::uint8_t {
+  EMPTY = 0x80u,
+  DELETED = 0xFEu
+};
+
+constexpr bool is_full_slot( std::uint8_t v ) {
+  return !( v & 0x80u );
+}
+
+constexpr std::uint8_t get_slot_tag( std::size_t hash ) {
+  return std::uint8_t( hash >> ( sizeof( std::size_t ) * 8u - 7u ) );
+}
+
+}
+
+template<
+  std::unsigned_integral K,
+  typename V,
+  typename Hash = std::hash< K >,
+  typename Pred = std::equal_to< K >,
+  typename Allocator = std::allocator< std::pair< const K, V > >
+>
+class flat_node_map {
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair< const K, V >;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = Pred;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+private:
+  using allocator_traits = std::allocator_traits< Allocator >;
+  template< bool is_const >
+  class iterator_base {
+    using map_type = std::conditional_t< is_const, const flat_node_map, flat_node_map >;
+  public:
+    using value_type = typename flat_node_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t< is_const, const value_type&, value_type& >;
+    using pointer = std::conditional_t< is_const, const value_type*, value_type* >;
+    using iterator_category = std::forward_iterator_tag;
+    iterator_base() = default;
+    iterator_base( map_type *map_, size_type index_ ) : map( map_ ), index( index_ ) {}
+    template< bool r_is_const, typename = std::enable_if_t< is_const && !r_is_const > >
+    iterator_base( const iterator_base< r_is_const > &r ) : map( r.map ), index( r.index ) {}
+    reference operator*() const {
+      return map->slots[ index ];
+    }
+    pointer operator->() const {
+      return &map->slots[ index ];
+    }
+    iterator_base &operator++() {
+      index = map->next_full( index + 1u );
+      return *this;
+    }
+    iterator_base operator++( int ) {
+      auto temp = *this;
+      ++*this;
+      return temp;
+    }
+    template< bool r_is_const >
+    bool operator==( const iterator_base< r_is_const > &r ) const {
+      return index == r.index;
+    }
+  private:
+    template< bool >
+    friend class iterator_base;
+    friend class flat_node_map;
+    map_type *map = nullptr;
+    size_type index = 0u;
+  };
+public:
+  using iterator = iterator_base< false >;
+  using const_iterator = iterator_base< true >;
+  flat_node_map(
+    const Hash &hash_ = Hash(),
+    const Pred &pred_ = Pred(),
+    const Allocator &allocator_ = Allocator()
+  ) : hash( hash_ ), pred( pred_ ), allocator( allocator_ ) {}
+  flat_node_map( const flat_node_map &r ) :
+    hash( r.hash ), pred( r.pred ),
+    allocator( allocator_traits::select_on_container_copy_construction( r.allocator ) ) {
+    reserve( r.size() );
+    for( const auto &v: r ) insert( v );
+  }
+  flat_node_map( flat_node_map &&r ) noexcept :
+    hash( std::move( r.hash ) ), pred( std::move( r.pred ) ), allocator( std::move( r.allocator ) ),
+    ctrl( std::exchange( r.ctrl, nullptr ) ), slots( std::exchange( r.slots, nullptr ) ),
+    capacity( std::exchange( r.capacity, 0u ) ), used( std::exchange( r.used, 0u ) ),
+    deleted( std::exchange( r.deleted, 0u ) ) {}
+  flat_node_map &operator=( const flat_node_map &r ) {
+    if( this != &r ) {
+      flat_node_map temp( r );
+      swap( temp );
+    }
+    return *this;
+  }
+  flat_node_map &operator=( flat_node_map &&r ) noexcept {
+    if( this != &r ) {
+      flat_node_map temp( std::move( r ) );
+      swap( temp );
+    }
+    return *this;
+  }
+  ~flat_node_map() {
+    release();
+  }
+  void swap( flat_node_map &r ) noexcept {
+    std::swap( hash, r.hash );
+    std::swap( pred, r.pred );
+    std::swap( allocator, r.allocator );
+    std::swap( ctrl, r.ctrl );
+    std::swap( slots, r.slots );
+    std::swap( capacity, r.capacity );
+    std::swap( used, r.used );
+    std::swap( deleted, r.deleted );
+  }
+  iterator begin() {
+    return iterator( this, next_full( 0u ) );
+  }
+  const_iterator begin() const {
+    return const_iterator( this, next_full( 0u ) );
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  iterator end() {
+    return iterator( this, capacity );
+  }
+  const_iterator end() const {
+    return const_iterator( this, capacity );
+  }
+  const_iterator cend() const {
+    return end();
+  }
+  bool empty() const {
+    return used == 0u;
+  }
+  size_type size() const {
+    return used;
+  }
+  size_type max_size() const {
+    return std::min< size_type >( allocator_traits::max_size( allocator ), std::numeric_limits< std::ptrdiff_t >::max() );
+  }
+  size_type bucket_count() const {
+    return capacity;
+  }
+  void clear() {
+    for( size_type i = 0u; i != capacity; ++i ) {
+      if( detail::is_full_slot( ctrl[ i ] ) ) allocator_traits::destroy( allocator, &slots[ i ] );
+      ctrl[ i ] = std::uint8_t( detail::slot_state_t::EMPTY );
+    }
+    used = 0u;
+    deleted = 0u;
+  }
+  void reserve( size_type n ) {
+    size_type required = 16u;
+    while( required - required / 8u < n ) required <<= 1u;
+    if( required > capacity ) rehash( required );
+  }
+  iterator find( const K &key ) {
+    return iterator( this, find_index( key ) );
+  }
+  const_iterator find( const K &key ) const {
+    return const_iterator( this, find_index( key ) );
+  }
+  size_type count( const K &key ) const {
+    return find_index( key ) != capacity;
+  }
+  bool contains( const K &key ) const {
+    return find_index( key ) != capacity;
+  }
+  // Hint that key is going to be looked up soon
+  void prefetch( const K &key ) const {
+    if( capacity == 0u ) return;
+    const auto index = hash( key ) & ( capacity - 1u );
+#if defined( __GNUC__ )
+    __builtin_prefetch( &ctrl[ index ] );
+    __builtin_prefetch( &slots[ index ] );
+#else
+    static_cast< void >( index );
+#endif
+  }
+  template< typename P >
+  std::pair< iterator, bool > insert( P &&v ) {
+    return emplace( std::forward< P >( v ).first, std::forward< P >( v ).second );
+  }
+  template< typename M >
+  std::pair< iterator, bool > emplace( const K &key, M &&mapped ) {
+    const auto h = hash( key );
+    const auto existing = find_index( key, h );
+    if( existing != capacity ) return std::make_pair( iterator( this, existing ), false );
+    if( ( used + deleted + 1u ) * 8u > capacity * 7u ) {
+      rehash( ( used + 1u ) * 2u * 8u > capacity * 7u ? std::max< size_type >( capacity * 2u, 16u ) : capacity );
+    }
+    const auto index = find_free( h );
+    if( ctrl[ index ] == std::uint8_t( detail::slot_state_t::DELETED ) ) --deleted;
+    allocator_traits::construct( allocator, &slots[ index ], key, std::forward< M >( mapped ) );
+    ctrl[ index ] = detail::get_slot_tag( h );
+    ++used;
+    return std::make_pair( iterator( this, index ), true );
+  }
+  size_type erase( const K &key ) {
+    const auto index = find_index( key );
+    if( index == capacity ) return 0u;
+    erase_index( index );
+    return 1u;
+  }
+  iterator erase( const_iterator pos ) {
+    erase_index( pos.index );
+    return iterator( this, next_full( pos.index + 1u ) );
+  }
+  iterator erase( iterator pos ) {
+    return erase( const_iterator( pos ) );
+  }
+  hasher hash_function() const {
+    return hash;
+  }
+  key_equal key_eq() const {
+    return pred;
+  }
+  allocator_type get_allocator() const {
+    return allocator;
+  }
+private:
+  size_type next_full( size_type index ) const {
+    while( index < capacity && !detail::is_full_slot( ctrl[ index ] ) ) ++index;
+    return index;
+  }
+  size_type find_index( const K &key ) const {
+    if( used == 0u ) return capacity;
+    return find_index( key, hash( key ) );
+  }
+  size_type find_index( const K &key, std::size_t h ) const {
+    if( capacity == 0u ) return capacity;
+    const auto tag = detail::get_slot_tag( h );
+    const auto mask = capacity - 1u;
+    for( size_type index = h & mask;; index = ( index + 1u ) & mask ) {
+      const auto state = ctrl[ index ];
+      if( state == std::uint8_t( detail::slot_state_t::EMPTY ) ) return capacity;
+      if( state == tag && pred( slots[ index ].first, key ) ) return index;
+    }
+  }
+  size_type find_free( std::size_t h ) const {
+    const auto mask = capacity - 1u;
+    for( size_type index = h & mask;; index = ( index + 1u ) & mask ) {
+      if( !detail::is_full_slot( ctrl[ index ] ) ) return index;
+    }
+  }
+  void erase_index( size_type index ) {
+    assert( index < capacity && detail::is_full_slot( ctrl[ index ] ) );
+    allocator_traits::destroy( allocator, &slots[ index ] );
+    const auto mask = capacity - 1u;
+    // a slot followed by an empty one is never on the probe sequence of another key
+    if( ctrl[ ( index + 1u ) & mask ] == std::uint8_t( detail::slot_state_t::EMPTY ) ) {
+      ctrl[ index ] = std::uint8_t( detail::slot_state_t::EMPTY );
+    }
+    else {
+      ctrl[ index ] = std::uint8_t( detail::slot_state_t::DELETED );
+      ++deleted;
+    }
+    --used;
+  }
+  void rehash( size_type new_capacity ) {
+    assert( std::has_single_bit( new_capacity ) );
+    if( new_capacity > max_size() ) {
+      throw std::length_error( "flat_node_map: The capacity exceeds the maximum size." );
+    }
+    auto new_ctrl = std::make_unique< std::uint8_t[] >( new_capacity );
+    std::fill( new_ctrl.get(), new_ctrl.get() + new_capacity, std::uint8_t( detail::slot_state_t::EMPTY ) );
+    auto new_slots = allocator_traits::allocate( allocator, new_capacity );
+    const auto mask = new_capacity - 1u;
+    for( size_type i = 0u; i != capacity; ++i ) {
+      if( detail::is_full_slot( ctrl[ i ] ) ) {
+        const auto h = hash( slots[ i ].first );
+        auto index = h & mask;
+        while( new_ctrl[ index ] != std::uint8_t( detail::slot_state_t::EMPTY ) ) index = ( index + 1u ) & mask;
+        allocator_traits::construct( allocator, &new_slots[ index ], slots[ i ].first, std::move( slots[ i ].second ) );
+        new_ctrl[ index ] = detail::get_slot_tag( h );
+        allocator_traits::destroy( allocator, &slots[ i ] );
+      }
+    }
+    if( slots ) allocator_traits::deallocate( allocator, slots, capacity );
+    delete[] ctrl;
+    ctrl = new_ctrl.release();
+    slots = new_slots;
+    capacity = new_capacity;
+    deleted = 0u;
+  }
+  void release() {
+    if( !slots ) return;
+    for( size_type i = 0u; i != capacity; ++i ) {
+      if( detail::is_full_slot( ctrl[ i ] ) ) allocator_traits::destroy( allocator, &slots[ i ] );
+    }
+    allocator_traits::deallocate( allocator, slots, capacity );
+    delete[] ctrl;
+    ctrl = nullptr;
+    slots = nullptr;
+    capacity = 0u;
+    used = 0u;
+    deleted = 0u;
+  }
+  Hash hash;
+  Pred pred;
+  Allocator allocator;
+  std::uint8_t *ctrl = nullptr;
+  value_type *slots = nullptr;
+  size_type capacity = 0u;
+  size_type used = 0u;
+  size_type deleted = 0u;
+};
+
+template<
+  std::unsigned_integral T,
+  typename U,
+  unsigned int dims,
+  typename Hash = key_hash< T, dims >,
+  typename Pred = std::equal_to< T >,
+  typename Allocator = std::allocator< std::pair< const T, detail::node< T, U, dims > > >
+>
+using flat_underlying_container_t = flat_node_map<
+  T,
+  detail::node< T, U, dims >,
+  Hash,
+  Pred,
+  Allocator
+>;
+
+}
+#endif
+
@@ -3,11 +3,18 @@
 
 #include <cstdint>
 #include <cassert>
+#include <array>
 #include <concepts>
 #include <bit>
 #include <vector>
+#include <utility>
+#include <functional>
+#include <algorithm>
 #include <variant>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <limits>
 #include <unordered_map>
 #include <type_traits>
 #include <boost/integer.hpp>
@@ -31,6 +38,11 @@ bool operator!=( const rectangle< T, dims > &l, const rectangle< T, dims > &r )
   return l.left_top != r.left_top || l.left_top != r.right_bottom;
 }
 
+enum class decomposition_mode_t {
+  FEWEST,
+  FASTEST
+};
+
 namespace detail {
 
 enum class camode_t {
@@ -615,6 +627,15 @@ struct child_availability_map< T, dims, std::enable_if_t< ( camap_traits< dims >
   }
 };
 
+// The state of an internal node made by splitting a leaf lazily.
+// The children missing from children hold value, the value of the leaf, except for the ones marked in holes, which are empty.
+template< KeyType T, typename U, unsigned int dims >
+struct inherited_value {
+  child_availability_map< T, dims > children;
+  typename camap_traits< dims >::type holes = 0u;
+  U value;
+};
+
 template< KeyType T, typename U, unsigned int dims >
 struct node {
   template< typename V >
@@ -627,8 +648,14 @@ struct node {
   bool is_leaf() const {
     return data.index() == 1u;
   }
+  // Whether this is an internal node whose children without a node hold the inherited value
+  bool is_inherited() const {
+    return data.index() == 2u;
+  }
+  // The value of a leaf, or the inherited value of an internal node
   const U &get_data() const {
-    assert( is_leaf() );
+    assert( is_leaf() || is_inherited() );
+    if( is_inherited() ) return std::get< 2u >( data ).value;
     return std::get< U >( data );
   }
   U &&move_data() {
@@ -637,6 +664,7 @@ struct node {
   }
   const child_availability_map< T, dims > &get_child_availability_map() const {
     assert( !is_leaf() );
+    if( is_inherited() ) return std::get< 2u >( data ).children;
     return std::get< child_availability_map< T, dims > >( data );
   }
   const U &operator*() const {
@@ -645,18 +673,44 @@ struct node {
   }
   bool has_child( const T &key ) const {
     assert( !is_leaf() );
-    const auto &camap_and_count = std::get< child_availability_map< T, dims > >( data );
-    return camap_and_count.has_child( get_depth< T, dims >( range ), key );
-  }
+    return get_child_availability_map().has_child( get_depth< T, dims >( range ), key );
+  }
+  // Whether the child slot containing key holds the inherited value
+  bool has_inherited_child( const T &key ) const {
+    if( !is_inherited() ) return false;
+    const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( range ) - 1u, key );
+    return get_inherited_children() & key_to_camap< T, dims >( child_key );
+  }
+  // The child slots holding the inherited value as a child availability map
+  typename camap_traits< dims >::type get_inherited_children() const {
+    if( !is_inherited() ) return 0u;
+    const auto &inherited = std::get< 2u >( data );
+    return typename camap_traits< dims >::type( get_camap_mask< dims >() & ~( get_camap< dims >( inherited.children.value ) | inherited.holes ) );
+  }
+  // The child slot of an inherited node becomes empty instead of taking the inherited value
+  void set_hole( const T &key ) {
+    assert( is_inherited() );
+    const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( range ) - 1u, key );
+    std::get< 2u >( data ).holes |= key_to_camap< T, dims >( child_key );
+  }
+  // Setting a child of an inherited node fills the hole there
   void set_child( const T &key ) {
     assert( !is_leaf() );
-    auto &camap_and_count = std::get< child_availability_map< T, dims > >( data );
-    camap_and_count.set_child( get_depth< T, dims >( range ), key );
+    if( is_inherited() ) {
+      auto &inherited = std::get< 2u >( data );
+      inherited.holes &= ~key_to_camap< T, dims >( get_key_in_depth< T, dims >( get_depth< T, dims >( range ) - 1u, key ) );
+      inherited.children.set_child( get_depth< T, dims >( range ), key );
+    }
+    else std::get< child_availability_map< T, dims > >( data ).set_child( get_depth< T, dims >( range ), key );
   }
+  // The slot of a child removed from an inherited node becomes a hole
   void remove_child( const T &key ) {
     assert( !is_leaf() );
-    auto &camap_and_count = std::get< child_availability_map< T, dims > >( data );
-    camap_and_count.remove_child( get_depth< T, dims >( range ), key );
+    if( is_inherited() ) {
+      std::get< 2u >( data ).children.remove_child( get_depth< T, dims >( range ), key );
+      set_hole( key );
+    }
+    else std::get< child_availability_map< T, dims > >( data ).remove_child( get_depth< T, dims >( range ), key );
   }
   void set_data( U &&data_ ) {
     data = std::move( data_ );
@@ -664,22 +718,80 @@ struct node {
   void set_data( const U &data_ ) {
     data = data_;
   }
+  // The child slot of an inherited node holds the inherited value again, once the child is erased
+  void inherit_child( const T &key ) {
+    assert( is_inherited() );
+    std::get< 2u >( data ).children.remove_child( get_depth< T, dims >( range ), key );
+  }
+  // Turn a leaf into an internal node without children, whose child slots hold the value of the leaf except for holes
+  void set_inherited( typename camap_traits< dims >::type holes ) {
+    assert( is_leaf() );
+    data = inherited_value< T, U, dims >{ child_availability_map< T, dims >{}, holes, std::move( std::get< U >( data ) ) };
+  }
+  // Make an inherited node an ordinary internal node, which leaves the child slots without a node empty
+  void drop_inherited() {
+    assert( is_inherited() );
+    data = child_availability_map< T, dims >( std::get< 2u >( data ).children );
+  }
   void clear_child() {
     data = child_availability_map< T, dims >{};
   }
+  // Make this an internal node without children covering range_, in place
+  void reset_to_internal( const T &range_ ) {
+    range = range_;
+    data.template emplace< 0u >();
+  }
+  // The number of children having a node
   typename camap_traits< dims >::type get_count() const {
     assert( !is_leaf() );
-    auto &camap_and_count = std::get< child_availability_map< T, dims > >( data );
-    return camap_and_count.get_count();
+    return get_child_availability_map().get_count();
   }
   const T &get_range() const {
     return range;
   }
 private:
   T range = get_root_key< T, dims >();
-  std::variant< child_availability_map< T, dims >, U > data = child_availability_map< T, dims >();
+  std::variant< child_availability_map< T, dims >, U, inherited_value< T, U, dims > > data = child_availability_map< T, dims >();
+};
+
+// A leaf yielded by views::leaf, referring to the value of the leaf node or of the inherited node above it
+template< KeyType T, typename U, unsigned int dims >
+class leaf_reference {
+public:
+  leaf_reference(
+    const T &range_,
+    const U &data_
+  ) : range( range_ ), data( &data_ ) {}
+  bool is_leaf() const {
+    return true;
+  }
+  const T &get_range() const {
+    return range;
+  }
+  const U &get_data() const {
+    return *data;
+  }
+  const U &operator*() const {
+    return *data;
+  }
+private:
+  T range;
+  const U *data;
 };
 
+// Whether every voxel of slot_key holds the value of current_node, as current_node is a leaf containing the slot
+// or the slot is inside a child of current_node holding the inherited value.
+template< KeyType T, typename U, unsigned int dims >
+bool covers(
+  const node< T, U, dims > &current_node,
+  T slot_key
+) {
+  if( current_node.is_leaf() ) return contains< T, dims >( current_node.get_range(), slot_key );
+  if( !current_node.is_inherited() ) return false;
+  if( get_depth< T, dims >( current_node.get_range() ) <= get_depth< T, dims >( slot_key ) ) return false;
+  return contains< T, dims >( current_node.get_range(), slot_key ) && current_node.has_inherited_child( slot_key );
+}
+
 template< typename T >
 struct extract_dims {};
 template< typename K, typename T, typename U, unsigned int dims >
@@ -690,6 +802,14 @@ template< typename T, typename U, unsigned int dims >
 struct extract_dims< node< T, U, dims > > {
   constexpr static auto value = dims;
 };
+template< typename K, typename T, typename U, unsigned int dims >
+struct extract_dims< std::pair< K, leaf_reference< T, U, dims > > > {
+  constexpr static auto value = dims;
+};
+template< typename T, typename U, unsigned int dims >
+struct extract_dims< leaf_reference< T, U, dims > > {
+  constexpr static auto value = dims;
+};
 template< typename T, unsigned int dims >
 struct extract_dims< child_availability_map< T, dims > > {
   constexpr static auto value = dims;
@@ -700,7 +820,7 @@ struct extract_dims< rectangle< T, dims > > {
 };
 template< std::ranges::range R >
 struct extract_dims< R > :
-  public extract_dims< std::remove_cvref_t< decltype( std::ranges::begin( std::declval< R& >() )->second ) > > {};
+  public extract_dims< std::remove_cvref_t< decltype( ( *std::ranges::begin( std::declval< R& >() ) ).second ) > > {};
 template< typename T >
 constexpr auto extract_dims_v = extract_dims< T >::value;
 
@@ -714,6 +834,14 @@ template< typename T, typename U, unsigned int dims >
 struct extract_key_type< node< T, U, dims > > {
   using type = T;
 };
+template< typename K, typename T, typename U, unsigned int dims >
+struct extract_key_type< std::pair< K, leaf_reference< T, U, dims > > > {
+  using type = T;
+};
+template< typename T, typename U, unsigned int dims >
+struct extract_key_type< leaf_reference< T, U, dims > > {
+  using type = T;
+};
 template< typename T, unsigned int dims >
 struct extract_key_type< child_availability_map< T, dims > > {
   using type = T;
@@ -724,7 +852,7 @@ struct extract_key_type< rectangle< T, dims > > {
 };
 template< std::ranges::range R >
 struct extract_key_type< R > :
-  public extract_key_type< std::remove_cvref_t< decltype( std::ranges::begin( std::declval< R& >() )->second ) > > {};
+  public extract_key_type< std::remove_cvref_t< decltype( ( *std::ranges::begin( std::declval< R& >() ) ).second ) > > {};
 template< typename T >
 using extract_key_type_t = typename extract_key_type< T >::type;
 
@@ -738,9 +866,17 @@ template< typename T, typename U, unsigned int dims >
 struct extract_value_type< node< T, U, dims > > {
   using type = U;
 };
+template< typename K, typename T, typename U, unsigned int dims >
+struct extract_value_type< std::pair< K, leaf_reference< T, U, dims > > > {
+  using type = U;
+};
+template< typename T, typename U, unsigned int dims >
+struct extract_value_type< leaf_reference< T, U, dims > > {
+  using type = U;
+};
 template< std::ranges::range R >
 struct extract_value_type< R > :
-  public extract_value_type< std::remove_cvref_t< decltype( std::ranges::begin( std::declval< R& >() )->second ) > > {};
+  public extract_value_type< std::remove_cvref_t< decltype( ( *std::ranges::begin( std::declval< R& >() ) ).second ) > > {};
 template< typename T >
 using extract_value_type_t = typename extract_value_type< T >::type;
 
@@ -848,6 +984,74 @@ template< KeyType T, unsigned int dims >
 using depth_log_t =
   boost::container::static_vector< unsigned int, get_max_depth< T, dims >() >;
 
+// Descend from existing_node ( stored at slot root ) towards key and return the deepest node on the path.
+// The slot depth of each node passed on the way is appended to log.
+template< typename C, typename I >
+  requires HDMapUnderlyingContainer< std::remove_const_t< C > >
+I find_nearest_from(
+  C &map,
+  I existing_node,
+  extract_key_type_t< std::remove_const_t< C > > root,
+  extract_key_type_t< std::remove_const_t< C > > key,
+  depth_log_t< extract_key_type_t< std::remove_const_t< C > >, extract_dims_v< std::remove_const_t< C > > > &log
+) {
+  using T = extract_key_type_t< std::remove_const_t< C > >;
+  constexpr auto dims = extract_dims_v< std::remove_const_t< C > >;
+  const auto key_depth = get_depth< T, dims >( key );
+  while( !existing_node->second.is_leaf() ) {
+    const auto current_depth = get_depth< T, dims >( existing_node->second.get_range() );
+    if( current_depth <= key_depth && get_key_in_depth< T, dims >( key_depth, existing_node->second.get_range() ) == key ) break;
+    assert( current_depth != 0u );
+    const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
+    if( !existing_node->second.has_child( child_key ) ) break;
+    const auto child_node = map.find( child_key );
+    if( child_node == map.end() ) break;
+    log.push_back( get_depth< T, dims >( root ) );
+    root = child_key;
+    existing_node = child_node;
+  }
+  return existing_node;
+}
+
+// Every ancestor of key is stored at get_key_in_depth( d, key ) for some slot depth d.
+// Binary search over d finds a deep existing ancestor with O( log depth ) probes.
+// Compressed paths leave gaps in the slot depths, so the search is only used to pick a starting point
+// and the remaining levels are walked by find_nearest_from.
+template< typename C >
+  requires HDMapUnderlyingContainer< std::remove_const_t< C > >
+auto find_nearest_by_depth(
+  C &map,
+  extract_key_type_t< std::remove_const_t< C > > root,
+  extract_key_type_t< std::remove_const_t< C > > key
+) {
+  using T = extract_key_type_t< std::remove_const_t< C > >;
+  constexpr auto dims = extract_dims_v< std::remove_const_t< C > >;
+  if( map.empty() ) return map.end();
+  auto existing_node = map.find( root );
+  if( existing_node == map.end() ) return map.end();
+  if( existing_node->second.is_leaf() || covers( existing_node->second, key ) ) return existing_node;
+  const auto key_depth = get_depth< T, dims >( key );
+  auto lower = key_depth;
+  auto upper = get_depth< T, dims >( root );
+  while( lower < upper ) {
+    const auto middle = lower + ( upper - lower ) / 2u;
+    const auto slot_key = get_key_in_depth< T, dims >( middle, key );
+    const auto found = map.find( slot_key );
+    if( found != map.end() ) {
+      existing_node = found;
+      root = slot_key;
+      // nothing is stored below a child holding the inherited value
+      if( found->second.is_leaf() || covers( found->second, key ) ) return existing_node;
+      upper = middle;
+    }
+    else {
+      lower = middle + 1u;
+    }
+  }
+  depth_log_t< T, dims > log;
+  return find_nearest_from( map, existing_node, root, key, log );
+}
+
 template< HDMapUnderlyingContainer C >
 auto find_nearest(
   C &map,
@@ -855,22 +1059,10 @@ auto find_nearest(
   extract_key_type_t< C > key,
   depth_log_t< extract_key_type_t< C >, extract_dims_v< C > > &log
 ) {
-  using T = extract_key_type_t< C >;
-  constexpr auto dims = extract_dims_v< C >;
   if( map.empty() ) return map.end();
   const auto existing_node = map.find( root );
   if( existing_node == map.end() ) return map.end();
-  if( existing_node->second.is_leaf() ) return existing_node;
-  const auto current_depth = get_depth< T, dims >( existing_node->second.get_range() );
-  const auto key_depth = get_depth< T, dims >( key );
-  if( current_depth <= key_depth && get_key_in_depth< T, dims >( key_depth, existing_node->second.get_range() ) == key ) return existing_node;
-  assert( current_depth != 0u );
-  const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
-  if( !existing_node->second.has_child( child_key ) ) return existing_node;
-  log.push_back( get_depth< T, dims >( root ) );
-  auto lower = find_nearest( map, child_key, key, log );
-  if( lower == map.end() ) return existing_node;
-  return lower;
+  return find_nearest_from( map, existing_node, root, key, log );
 }
 
 template< HDMapUnderlyingContainer C >
@@ -880,22 +1072,10 @@ auto find_nearest(
   extract_key_type_t< C > key,
   depth_log_t< extract_key_type_t< C >, extract_dims_v< C > > &log
 ) {
-  using T = extract_key_type_t< C >;
-  constexpr auto dims = extract_dims_v< C >;
   if( map.empty() ) return map.end();
   const auto existing_node = map.find( root );
   if( existing_node == map.end() ) return map.end();
-  if( existing_node->second.is_leaf() ) return existing_node;
-  const auto current_depth = get_depth< T, dims >( existing_node->second.get_range() );
-  const auto key_depth = get_depth< T, dims >( key );
-  if( current_depth <= key_depth && get_key_in_depth< T, dims >( key_depth, existing_node->second.get_range() ) == key ) return existing_node;
-  assert( current_depth != 0u );
-  const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
-  if( !existing_node->second.has_child( child_key ) ) return existing_node;
-  log.push_back( get_depth< T, dims >( root ) );
-  auto lower = find_nearest( map, child_key, key, log );
-  if( lower == map.end() ) return existing_node;
-  return lower;
+  return find_nearest_from( map, existing_node, root, key, log );
 }
 
 template< HDMapUnderlyingContainer C >
@@ -904,21 +1084,7 @@ auto find_nearest(
   extract_key_type_t< C > root,
   extract_key_type_t< C > key
 ) {
-  using T = extract_key_type_t< C >;
-  constexpr auto dims = extract_dims_v< C >;
-  if( map.empty() ) return map.end();
-  const auto existing_node = map.find( root );
-  if( existing_node == map.end() ) return map.end();
-  if( existing_node->second.is_leaf() ) return existing_node;
-  const auto current_depth = get_depth< T, dims >( existing_node->second.get_range() );
-  const auto key_depth = get_depth< T, dims >( key );
-  if( current_depth <= key_depth && get_key_in_depth< T, dims >( key_depth, existing_node->second.get_range() ) == key ) return existing_node;
-  assert( current_depth != 0u );
-  const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
-  if( !existing_node->second.has_child( child_key ) ) return existing_node;
-  auto lower = find_nearest( map, child_key, key );
-  if( lower == map.end() ) return existing_node;
-  return lower;
+  return find_nearest_by_depth( map, root, key );
 }
 
 template< HDMapUnderlyingContainer C >
@@ -927,21 +1093,7 @@ auto find_nearest(
   extract_key_type_t< C > root,
   extract_key_type_t< C > key
 ) {
-  using T = extract_key_type_t< C >;
-  constexpr auto dims = extract_dims_v< C >;
-  if( map.empty() ) return map.end();
-  const auto existing_node = map.find( root );
-  if( existing_node == map.end() ) return map.end();
-  if( existing_node->second.is_leaf() ) return existing_node;
-  const auto current_depth = get_depth< T, dims >( existing_node->second.get_range() );
-  const auto key_depth = get_depth< T, dims >( key );
-  if( current_depth <= key_depth && get_key_in_depth< T, dims >( key_depth, existing_node->second.get_range() ) == key ) return existing_node;
-  assert( current_depth != 0u );
-  const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
-  if( !existing_node->second.has_child( child_key ) ) return existing_node;
-  auto lower = find_nearest( map, child_key, key );
-  if( lower == map.end() ) return existing_node;
-  return lower;
+  return find_nearest_by_depth( map, root, key );
 }
 
 template< HDMapUnderlyingContainer C >
@@ -1180,6 +1332,7 @@ auto for_each_child_key(
 
 
 
+// The leaf containing key, or the inherited node whose child containing key holds the inherited value
 template< HDMapUnderlyingContainer C >
 auto find(
   C &map,
@@ -1189,14 +1342,146 @@ auto find(
   constexpr auto dims = extract_dims_v< C >;
   auto nearest_node = find_nearest( map, get_root_key< T, dims >(), key );
   if( nearest_node == map.end() ) return map.end();
-  if( nearest_node->second.is_leaf() ) {
-    if( nearest_node->second.get_range() == key ) return nearest_node;
-    if( nearest_node->second.get_range() == get_key_in_depth< T, dims >( get_depth< T, dims >( nearest_node->second.get_range() ), key ) ) return nearest_node;
-    return map.end();
-  }
+  if( covers( nearest_node->second, key ) ) return nearest_node;
   return map.end();
 }
 
+template< HDMapUnderlyingContainer C >
+void prefetch_node(
+  const C &map,
+  const extract_key_type_t< C > &key
+) {
+  if constexpr ( requires { map.prefetch( key ); } ) {
+    map.prefetch( key );
+  }
+}
+
+// Child indices from the root down to depth 0 concatenated, so that sorting by this code visits voxels in Morton order
+// key must be a voxel ( depth 0 )
+template< KeyType T, unsigned int dims >
+constexpr std::uint64_t get_morton_code( T key ) {
+  std::uint64_t code = 0u;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    const std::uint64_t component = get_raw_component< T, dims >( i, key );
+    for( unsigned int level = 0u; level != get_max_depth< T, dims >(); ++level ) {
+      code |= ( ( component >> ( 2u * level ) ) & 0x3u ) << ( 2u * ( dims * level + i ) );
+    }
+  }
+  return code;
+}
+
+// LSD radix sort of values by the bits [ begin, end ) of get_code( value )
+template< typename V, typename F >
+void radix_sort(
+  std::vector< V > &values,
+  unsigned int begin,
+  unsigned int end,
+  F &&get_code
+) {
+  constexpr unsigned int digit_bits = 11u;
+  constexpr std::size_t bucket_count = 1u << digit_bits;
+  std::vector< V > temp( values.size() );
+  std::vector< std::size_t > offsets( bucket_count + 1u );
+  for( unsigned int shift = begin; shift < end; shift += digit_bits ) {
+    std::fill( offsets.begin(), offsets.end(), 0u );
+    for( const auto &v: values ) ++offsets[ ( ( get_code( v ) >> shift ) & ( bucket_count - 1u ) ) + 1u ];
+    for( std::size_t i = 1u; i != offsets.size(); ++i ) offsets[ i ] += offsets[ i - 1u ];
+    for( const auto &v: values ) temp[ offsets[ ( get_code( v ) >> shift ) & ( bucket_count - 1u ) ]++ ] = v;
+    values.swap( temp );
+  }
+}
+
+template< HDMapUnderlyingContainer C, typename O, typename G, typename F >
+void find_points_in_order(
+  const C &map,
+  std::span< const extract_key_type_t< C > > keys,
+  const O &order,
+  G &&get_index,
+  F &func
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  using iterator = typename C::const_iterator;
+  const auto root_key = get_root_key< T, dims >();
+  const auto root_node = map.find( root_key );
+  if( root_node == map.end() ) {
+    for( const auto &o: order ) func( get_index( o ), map.end() );
+    return;
+  }
+  boost::container::static_vector< std::pair< T, iterator >, get_max_depth< T, dims >() + 1u > path;
+  path.emplace_back( root_key, root_node );
+  for( std::size_t i = 0u; i != order.size(); ++i ) {
+    const auto index = get_index( order[ i ] );
+    const auto &key = keys[ index ];
+    while( path.size() > 1u && get_key_in_depth< T, dims >( get_depth< T, dims >( path.back().first ), key ) != path.back().first ) {
+      path.pop_back();
+    }
+    while( !path.back().second->second.is_leaf() ) {
+      const auto &current_node = path.back().second->second;
+      const auto current_depth = get_depth< T, dims >( current_node.get_range() );
+      if( current_depth == 0u ) break;
+      const auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, key );
+      if( !current_node.has_child( child_key ) ) break;
+      const auto child_node = map.find( child_key );
+      if( child_node == map.end() ) break;
+      path.emplace_back( child_key, child_node );
+    }
+    if( i + 1u != order.size() && path.size() > 1u ) {
+      // The next voxel most likely ends up in a sibling of this leaf
+      prefetch_node( map, get_key_in_depth< T, dims >( get_depth< T, dims >( path.back().first ), keys[ get_index( order[ i + 1u ] ) ] ) );
+    }
+    const auto &found = path.back().second;
+    if( covers( found->second, key ) ) func( index, found );
+    else func( index, map.end() );
+  }
+}
+
+// Look up many voxels at once.
+// The queries are visited in Morton order and the path to the previous voxel is kept,
+// so that only the levels below the common ancestor of two consecutive voxels are probed again.
+// func( index, node ) is called once for each keys[ index ] with the node find would return for it or map.end().
+template< HDMapUnderlyingContainer C, typename F >
+void find_points(
+  const C &map,
+  std::span< const extract_key_type_t< C > > keys,
+  F &&func
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  constexpr unsigned int code_bits = 2u * dims * get_max_depth< T, dims >();
+  // Consecutive voxels only need to share most of their path, so the lowest levels are left unsorted
+  constexpr unsigned int sort_begin = code_bits > 22u ? code_bits - 22u : 0u;
+  if constexpr ( code_bits <= 32u ) {
+    // Short codes are packed with the index into a single word to halve the memory traffic of the sort
+    assert( keys.size() <= std::numeric_limits< std::uint32_t >::max() );
+    std::vector< std::uint64_t > order;
+    order.reserve( keys.size() );
+    for( std::size_t i = 0u; i != keys.size(); ++i ) {
+      assert( ( get_depth< T, dims >( keys[ i ] ) == 0u ) );
+      order.push_back( ( get_morton_code< T, dims >( keys[ i ] ) << 32u ) | i );
+    }
+    if( !std::is_sorted( order.begin(), order.end() ) ) {
+      radix_sort( order, sort_begin, code_bits, []( std::uint64_t v ) { return v >> 32u; } );
+    }
+    find_points_in_order( map, keys, order, []( std::uint64_t v ) { return std::size_t( v & 0xFFFFFFFFu ); }, func );
+  }
+  else {
+    std::vector< std::pair< std::uint64_t, std::size_t > > order;
+    order.reserve( keys.size() );
+    for( std::size_t i = 0u; i != keys.size(); ++i ) {
+      assert( ( get_depth< T, dims >( keys[ i ] ) == 0u ) );
+      if constexpr ( code_bits <= 64u ) order.emplace_back( get_morton_code< T, dims >( keys[ i ] ), i );
+      else order.emplace_back( 0u, i );
+    }
+    if constexpr ( code_bits <= 64u ) {
+      if( !std::is_sorted( order.begin(), order.end() ) ) {
+        radix_sort( order, sort_begin, code_bits, []( const auto &v ) { return v.first; } );
+      }
+    }
+    find_points_in_order( map, keys, order, []( const auto &v ) { return v.second; }, func );
+  }
+}
+
 template< std::unsigned_integral T, unsigned int dims >
 constexpr auto get_max_leaf_count(
   T key
@@ -1241,6 +1526,10 @@ auto is_uniform_of(
   constexpr auto dims = extract_dims_v< C >;
   const unsigned int current_range = current_node.get_range();
   unsigned int count = 0u;
+  if( current_node.is_inherited() ) {
+    if( !func( value, current_node.get_data() ) ) return false;
+    count += std::popcount( current_node.get_inherited_children() ) * ( get_max_leaf_count< T, dims >( current_range ) / get_max_child_count< dims >() );
+  }
   for_each_child(
     map,
     current_node,
@@ -1313,6 +1602,49 @@ auto get_overlap_count(
   return get_overlap_count_internal< T, dims, 0u >( l, r );
 }
 
+template< std::unsigned_integral T, unsigned int dims >
+rectangle< T, dims > operator&(
+  const rectangle< T, dims > &l,
+  const rectangle< T, dims > &r
+) {
+  rectangle< T, dims > temp;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    set_component< T, dims >( i, temp.left_top, std::max( get_component< T, dims >( i, l.left_top ), get_component< T, dims >( i, r.left_top ) ) );
+    set_component< T, dims >( i, temp.right_bottom, std::min( get_component< T, dims >( i, l.right_bottom ), get_component< T, dims >( i, r.right_bottom ) ) );
+    if( get_component< T, dims >( i, temp.left_top ) >= get_component< T, dims >( i, temp.right_bottom ) )
+      return rectangle< T, dims >{};
+  }
+  return temp;
+}
+
+// Call func for each of the up to 2 * dims disjoint rectangles covering l minus r
+template< std::unsigned_integral T, unsigned int dims, typename F >
+void subtract_rectangle(
+  const rectangle< T, dims > &l,
+  const rectangle< T, dims > &r,
+  F &&func
+) {
+  if( get_overlap_count( l, r ) == 0u ) {
+    func( l );
+    return;
+  }
+  auto remaining = l;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    if( get_component< T, dims >( i, remaining.left_top ) < get_component< T, dims >( i, r.left_top ) ) {
+      auto piece = remaining;
+      set_component< T, dims >( i, piece.right_bottom, get_component< T, dims >( i, r.left_top ) );
+      func( piece );
+      set_component< T, dims >( i, remaining.left_top, get_component< T, dims >( i, r.left_top ) );
+    }
+    if( get_component< T, dims >( i, remaining.right_bottom ) > get_component< T, dims >( i, r.right_bottom ) ) {
+      auto piece = remaining;
+      set_component< T, dims >( i, piece.left_top, get_component< T, dims >( i, r.right_bottom ) );
+      func( piece );
+      set_component< T, dims >( i, remaining.right_bottom, get_component< T, dims >( i, r.right_bottom ) );
+    }
+  }
+}
+
 template< typename T >
 struct covering_rectangle {
   using type =
@@ -1331,48 +1663,80 @@ auto get_right_bottom(
   T key
 );
 
-template< std::ranges::range Range, typename F >
-auto is_uniform_of(
-  Range &&leaves,
-  const covering_rectangle_t< Range > &range,
-  const extract_value_type_t< Range > &value,
-  unsigned int axis,
-  const F &func
+template< std::unsigned_integral L, unsigned int dims, std::unsigned_integral T >
+auto to_rectangle(
+  T key
 ) {
-  using rect_t = covering_rectangle_t< Range >;
-  using T = extract_key_type_t< rect_t >;
-  constexpr auto dims = extract_dims_v< rect_t >;
-  const auto expected_count = get_overlap_count< T, dims >( range, range );
-  T count = 0u;
-  T min = 0u;
-  T max = get_component_max< T, dims >();
-  for( const auto &[key,leaf]: leaves ) {
-    if constexpr ( is_struct_key_v< T > ) {
-      if( !func( leaf.get_data(), value ) ) return std::make_tuple( false, T{}, T{} );
-    }
-    else {
-      if( !func( leaf.get_data(), value ) ) return std::make_tuple( false, T( 0u ), T( 0u ) );
-    }
-    const auto extended_leaf_left_top = key_cast< T, dims >( leaf.get_range() );
-    const auto extended_leaf_right_bottom = get_right_bottom< T, dims >( extended_leaf_left_top );
-    const auto overlap = get_overlap_count( rect_t{ extended_leaf_left_top, extended_leaf_right_bottom }, range );
-    if( overlap ) {
-      count += overlap;
-      min = std::max( min, get_component< T, dims >( axis, extended_leaf_left_top ) );
-      max = std::min( max, get_component< T, dims >( axis, extended_leaf_right_bottom ) );
-    }
-  }
-  if( expected_count == count ) return std::make_tuple( true, min, max );
-  else {
-    if constexpr ( is_struct_key_v< T > ) {
-      return std::make_tuple( false, T{}, T{} );
+  const auto extended_key_left_top = key_cast< L, dims >( key );
+  return rectangle< L, dims >{ extended_key_left_top, get_right_bottom< L, dims >( extended_key_left_top ) };
+}
+
+// Call func( child_key, covered ) for each child slot of key overlapping range in child index order.
+// covered tells whether range contains the whole child. The children outside range are never visited.
+template< std::unsigned_integral T, unsigned int dims, std::unsigned_integral L, typename F >
+bool for_each_overlapping_child(
+  T key,
+  const rectangle< L, dims > &range,
+  F &&func
+) {
+  const auto child_depth = get_depth< T, dims >( key ) - 1u;
+  const auto child_width_bits = child_depth * 2u;
+  std::array< unsigned int, dims > begin;
+  std::array< unsigned int, dims > end;
+  std::array< unsigned int, dims > covered_begin;
+  std::array< unsigned int, dims > covered_end;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    const L node_begin = get_component< T, dims >( i, key );
+    const L node_end = node_begin + ( L( 4u ) << child_width_bits );
+    const L clipped_begin = std::max( node_begin, L( get_component< L, dims >( i, range.left_top ) ) );
+    const L clipped_end = std::min( node_end, L( get_component< L, dims >( i, range.right_bottom ) ) );
+    if( clipped_begin >= clipped_end ) return true;
+    const L overlap_begin = clipped_begin - node_begin;
+    const L overlap_end = clipped_end - node_begin;
+    const L child_mask = ( L( 1u ) << child_width_bits ) - 1u;
+    begin[ i ] = overlap_begin >> child_width_bits;
+    end[ i ] = ( overlap_end + child_mask ) >> child_width_bits;
+    covered_begin[ i ] = ( overlap_begin + child_mask ) >> child_width_bits;
+    covered_end[ i ] = overlap_end >> child_width_bits;
+  }
+  const auto first_child_key = get_key_in_depth< T, dims >( child_depth, key );
+  auto position = begin;
+  while( true ) {
+    unsigned int index = 0u;
+    bool covered = true;
+    for( unsigned int i = 0u; i != dims; ++i ) {
+      index |= position[ i ] << ( i * 2u );
+      covered = covered && covered_begin[ i ] <= position[ i ] && position[ i ] < covered_end[ i ];
     }
-    else {
-      return std::make_tuple( false, T( 0u ), T( 0u ) );
+    if( !func( child_index_to_key< T, dims >( first_child_key, index ), covered ) ) return false;
+    // the lowest axis varies fastest, which keeps the child index order
+    unsigned int i = 0u;
+    for( ; i != dims; ++i ) {
+      if( ++position[ i ] != end[ i ] ) break;
+      position[ i ] = begin[ i ];
     }
+    if( i == dims ) return true;
   }
 }
 
+// Call func( key ) for each key of the minimal set of aligned nodes below key whose union is the part of range inside key.
+// The keys come in depth first order and only the nodes crossing the border of range are descended, so the cost
+// follows the boundary of range rather than its volume.
+template< std::unsigned_integral T, unsigned int dims, std::unsigned_integral L, typename F >
+bool for_each_covering_key(
+  T key,
+  const rectangle< L, dims > &range,
+  F &&func
+) {
+  return for_each_overlapping_child< T, dims >(
+    key,
+    range,
+    [&]( T child_key, bool covered ) {
+      if( covered ) return bool( func( child_key ) );
+      return for_each_covering_key< T, dims >( child_key, range, func );
+    }
+  );
+}
 
 template< HDMapUnderlyingContainer C >
 void erase_children(
@@ -1389,6 +1753,48 @@ void erase_children(
   );
 }
 
+// The default for the on_volume callbacks below.
+// They are told the value and the change in voxel count each time leaves are dropped or written.
+struct ignore_volume_change {
+  template< typename U >
+  void operator()( const U&, std::int64_t ) const {}
+};
+
+// Erase every descendant of current_node and return the number of voxels they covered
+template<
+  HDMapUnderlyingContainer C,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
+unsigned int erase_descendants(
+  C &map,
+  const extract_node_type_t< C > &current_node,
+  V &&on_volume = V{}
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  unsigned int erased_count = 0u;
+  if( const auto inherited = std::popcount( current_node.get_inherited_children() ) ) {
+    const auto leaves = inherited * ( get_max_leaf_count< T, dims >( current_node.get_range() ) / get_max_child_count< dims >() );
+    on_volume( current_node.get_data(), -std::int64_t( leaves ) );
+    erased_count += leaves;
+  }
+  for(
+    auto [child_key,child_index] = get_child_key( map, current_node );
+    child_index != get_max_child_count< dims >();
+    std::tie( child_key, child_index ) = get_child_key( map, current_node, child_index + 1u )
+  ) {
+    const auto child_node = map.find( child_key );
+    if( child_node == map.end() ) continue;
+    if( child_node->second.is_leaf() ) {
+      const auto leaves = get_max_leaf_count< T, dims >( child_node->second.get_range() );
+      on_volume( child_node->second.get_data(), -std::int64_t( leaves ) );
+      erased_count += leaves;
+    }
+    else erased_count += erase_descendants( map, child_node->second, on_volume );
+    map.erase( child_node );
+  }
+  return erased_count;
+}
 
 template< HDMapUnderlyingContainer C, typename F >
 auto insert(
@@ -1425,14 +1831,21 @@ auto insert(
   }
   if( !nearest_node->second.is_leaf() ) {
     if( nearest_node->second.get_range() != key ) { // conflict
+      // the child holds the inherited value
+      if( nearest_node->second.has_inherited_child( key ) ) return std::make_pair( nearest_node, false );
       const auto new_value_key = key;
       const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( nearest_node->second.get_range() ) - 1u, key );
       nearest_node->second.set_child( child_key );
+      const auto inherited = std::popcount( nearest_node->second.get_inherited_children() );
+      if( nearest_node->second.is_inherited() && !inherited ) nearest_node->second.drop_inherited();
+      // the container may relocate its elements on insertion
+      const auto parent_key = nearest_node->first;
+      const bool filled = nearest_node->second.get_count() + inherited == get_max_child_count< dims >();
       auto insert_result = map.insert( std::make_pair( child_key, node< T, U, dims >( new_value_key, std::move( value ) ) ) );
       assert( insert_result.second );
       auto &inserted_value = insert_result.first->second.get_data();
-      if( nearest_node->second.get_count() == get_max_child_count< dims >() ) {
-        auto current_key = nearest_node->first;
+      if( filled ) {
+        auto current_key = parent_key;
         auto value = inserted_value;
         while( is_uniform_of( map, current_key, value, func ) ) {
           erase_children( map, current_key );
@@ -1450,10 +1863,20 @@ auto insert(
   return std::make_pair( nearest_node, false );
 }
 
-template< HDMapUnderlyingContainer C >
+// Turn the leaf current_node into an internal node whose children hold its value.
+// The children for which skip returns true are left out, the caller is about to erase or overwrite them.
+// With a full child availability map no child is inserted. current_node becomes an inherited node, and the children
+// left out are its holes. Otherwise every other child is inserted with a copy of the value.
+template<
+  HDMapUnderlyingContainer C,
+  std::predicate< extract_key_type_t< C > > F,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
 void split(
   C &map,
-  extract_node_type_t< C > &current_node
+  extract_node_type_t< C > &current_node,
+  F &&skip,
+  V &&on_volume = V{}
 ) {
   using T = extract_key_type_t< C >;
   using U = extract_value_type_t< C >;
@@ -1461,29 +1884,136 @@ void split(
   assert( current_node.is_leaf() );
   const auto current_depth = get_depth< T, dims >( current_node.get_range() );
   assert( current_depth > 0u );
-  auto value = current_node.get_data();
-  current_node.clear_child();
+  [[maybe_unused]] boost::container::static_vector< T, get_max_child_count< dims >() > child_keys;
+  [[maybe_unused]] typename camap_traits< dims >::type holes = 0u;
+  std::int64_t skipped = 0;
   {
     auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, current_node.get_range() );
     for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
-      current_node.set_child( child_key );
+      if( skip( child_key ) ) {
+        if constexpr ( camap_traits< dims >::mode == camode_t::FULL ) holes |= key_to_camap< T, dims >( child_key );
+        skipped += get_max_leaf_count< T, dims >( child_key );
+      }
+      else if constexpr ( camap_traits< dims >::mode != camode_t::FULL ) child_keys.push_back( child_key );
       child_key = next_key< T, dims >( child_key, 1u );
     }
   }
-  {
-    auto child_key = get_key_in_depth< T, dims >( current_depth - 1u, current_node.get_range() );
-    for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
-      auto insert_result = map.insert( std::make_pair( child_key, node< T, U, dims >( child_key, U( value ) ) ) );
+  if( skipped ) on_volume( current_node.get_data(), -skipped );
+  if constexpr ( camap_traits< dims >::mode == camode_t::FULL ) {
+    current_node.set_inherited( holes );
+  }
+  else {
+    auto value = current_node.move_data();
+    // current_node may be relocated once the children are inserted
+    current_node.clear_child();
+    for( const auto &child_key: child_keys ) current_node.set_child( child_key );
+    for( std::size_t i = 0u; i != child_keys.size(); ++i ) {
+      [[maybe_unused]] const auto insert_result = ( i + 1u == child_keys.size() ) ?
+        map.insert( std::make_pair( child_keys[ i ], node< T, U, dims >( child_keys[ i ], std::move( value ) ) ) ) :
+        map.insert( std::make_pair( child_keys[ i ], node< T, U, dims >( child_keys[ i ], U( value ) ) ) );
       assert( insert_result.second );
-      child_key = next_key< T, dims >( child_key, 1u );
     }
   }
 }
 
 template< HDMapUnderlyingContainer C >
+void split(
+  C &map,
+  extract_node_type_t< C > &current_node
+) {
+  split( map, current_node, []( const auto& ) { return false; } );
+}
+
+// Split current_node leaving out the children range covers entirely and return the number of voxels left out
+template<
+  HDMapUnderlyingContainer C,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
+auto split(
+  C &map,
+  extract_node_type_t< C > &current_node,
+  const covering_rectangle_t< C > &range,
+  V &&on_volume = V{}
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  std::array< bool, get_max_child_count< dims >() > covered_children{};
+  L skipped = 0u;
+  for_each_overlapping_child< T, dims >(
+    current_node.get_range(),
+    range,
+    [&]( T child_key, bool covered ) {
+      if( covered ) {
+        covered_children[ key_to_child_index< T, dims >( child_key ) ] = true;
+        skipped += get_max_leaf_count< T, dims >( child_key );
+      }
+      return true;
+    }
+  );
+  split( map, current_node, [&]( T child_key ) { return covered_children[ key_to_child_index< T, dims >( child_key ) ]; }, on_volume );
+  return skipped;
+}
+
+// Insert the child of the inherited current_node containing key as a leaf holding the inherited value, so that it can be modified.
+// current_node may be relocated by the insertion.
+template< HDMapUnderlyingContainer C >
+void materialize_child(
+  C &map,
+  extract_node_type_t< C > &current_node,
+  extract_key_type_t< C > key
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  assert( current_node.has_inherited_child( key ) );
+  const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( current_node.get_range() ) - 1u, key );
+  U value = current_node.get_data();
+  current_node.set_child( child_key );
+  [[maybe_unused]] const auto insert_result = map.insert( std::make_pair( child_key, node< T, U, dims >( child_key, std::move( value ) ) ) );
+  assert( insert_result.second );
+}
+
+// Make the inherited node at slot_key an ordinary internal node once none of its children holds the inherited value.
+// A single child left takes its place to keep the path compressed, and so does a single child holding the inherited value.
+// Returns true if the node is left without children, which the caller has to erase.
+template< HDMapUnderlyingContainer C >
+bool settle_inherited(
+  C &map,
+  extract_key_type_t< C > slot_key
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto current_node = map.find( slot_key );
+  if( current_node == map.end() || !current_node->second.is_inherited() ) return false;
+  if( const auto inherited = current_node->second.get_inherited_children() ) {
+    if( std::popcount( inherited ) != 1 || current_node->second.get_count() ) return false;
+    const auto lower_key = get_key_in_depth< T, dims >( get_depth< T, dims >( current_node->second.get_range() ) - 1u, current_node->second.get_range() );
+    const auto child_key = child_index_to_key< T, dims >( lower_key, unsigned( std::countr_zero( inherited ) ) );
+    current_node->second = node< T, U, dims >( child_key, U( current_node->second.get_data() ) );
+    return false;
+  }
+  current_node->second.drop_inherited();
+  const auto child_count = current_node->second.get_count();
+  if( child_count == 0u ) return true;
+  if( child_count == 1u ) {
+    const auto [last_child_node,child_index] = get_child( map, current_node->second );
+    assert( last_child_node != map.end() );
+    current_node->second = std::move( last_child_node->second );
+    map.erase( last_child_node );
+  }
+  return false;
+}
+
+template<
+  HDMapUnderlyingContainer C,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
 auto erase(
   C &map,
-  extract_key_type_t< C > current_key
+  extract_key_type_t< C > current_key,
+  V &&on_volume = V{}
 ) {
   using T = extract_key_type_t< C >;
   constexpr auto dims = extract_dims_v< C >;
@@ -1495,41 +2025,51 @@ auto erase(
   }
   if( nearest_node->second.get_range() != current_key ) {
     if( !contains< T, dims >( current_key, nearest_node->second.get_range() ) ) {
-      if( contains< T, dims >( nearest_node->second.get_range(), current_key ) ) { // poking
-        assert( nearest_node->second.is_leaf() );
-        split( map, nearest_node->second );
-        return erase( map, current_key );
+      if( nearest_node->second.is_leaf() && contains< T, dims >( nearest_node->second.get_range(), current_key ) ) { // poking
+        const bool is_child = get_depth< T, dims >( nearest_node->second.get_range() ) == get_depth< T, dims >( current_key ) + 1u;
+        // current_key itself is not materialized just to be erased again
+        split( map, nearest_node->second, [&]( T child_key ) { return child_key == current_key; }, on_volume );
+        if( is_child ) return get_max_leaf_count< T, dims >( current_key );
+        return erase( map, current_key, on_volume );
+      }
+      else if( covers( nearest_node->second, current_key ) ) { // poking a child holding the inherited value
+        const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( nearest_node->second.get_range() ) - 1u, current_key );
+        if( child_key != current_key ) {
+          // only the child containing current_key is materialized
+          materialize_child( map, nearest_node->second, current_key );
+          return erase( map, current_key, on_volume );
+        }
+        const auto leaves = get_max_leaf_count< T, dims >( current_key );
+        on_volume( nearest_node->second.get_data(), -std::int64_t( leaves ) );
+        nearest_node->second.set_hole( current_key );
+        const auto range = nearest_node->second.get_range();
+        if( settle_inherited( map, nearest_node->first ) ) erase( map, range, on_volume );
+        return leaves;
       }
       else { // not found
         return 0u;
       }
     }
   }
-  unsigned int erased_child_count = 0u;
-  if( !nearest_node->second.is_leaf() ) { // is node
-    auto nearest_key = nearest_node->first;
-    for_each_child(
-      map,
-      nearest_key,
-      [&]( auto &child_node, auto ) {
-        erased_child_count += erase( map, child_node->first );
-        return true;
-      }
-    );
-    log.clear();
-    nearest_node = find_nearest( map, root_key, current_key, log );
-  }
-  assert( nearest_node->second.is_leaf() );
+  // the whole subtree goes away, so the descendants are dropped without restructuring their parents
+  const unsigned int erased_child_count = nearest_node->second.is_leaf() ? 0u : erase_descendants( map, nearest_node->second, on_volume );
+  const auto leaves = nearest_node->second.is_leaf() ? get_max_leaf_count< T, dims >( nearest_node->second.get_range() ) : 0u;
+  if( leaves ) on_volume( nearest_node->second.get_data(), -std::int64_t( leaves ) );
   if( nearest_node->first == get_root_key< T, dims >() ) { // is root
-    const auto leaves = get_max_leaf_count< T, dims >( nearest_node->second.get_range() );
     map.erase( nearest_node );
     assert( map.empty() );
-    return leaves;
+    return erased_child_count + leaves;
   }
   const auto parent_node = map.find( get_key_in_depth< T, dims >( log.back(), nearest_node->first ) );
   assert( parent_node != map.end() );
-  const auto leaves = get_max_leaf_count< T, dims >( nearest_node->second.get_range() );
   parent_node->second.remove_child( nearest_node->second.get_range() );
+  if( parent_node->second.is_inherited() ) { // the slot is left as a hole
+    const auto parent_key = parent_node->first;
+    const auto parent_range = parent_node->second.get_range();
+    map.erase( nearest_node );
+    if( settle_inherited( map, parent_key ) ) erase( map, parent_range, on_volume );
+    return erased_child_count + leaves;
+  }
   const auto left_children = parent_node->second.get_count();
   assert( left_children > 0u );
   if( left_children == 1u ) { // remove parent node and leaf
@@ -1538,12 +2078,12 @@ auto erase(
     parent_node->second = last_child_node->second;
     const auto last_child_key = last_child_node->first;
     map.erase( nearest_node );
-    assert( map.erase( last_child_key ) == 1u );
+    [[maybe_unused]] const auto erased_last_child = map.erase( last_child_key );
+    assert( erased_last_child == 1u );
     assert( !map.empty() );
     return erased_child_count + leaves;
   }
   // remove leaf only
-  assert( nearest_node->second.is_leaf() );
   map.erase( nearest_node );
   assert( !map.empty() );
   return erased_child_count + leaves;
@@ -1571,6 +2111,9 @@ auto copy(
         if( nearest_node->second.has_child( child_key ) ) {
           copy( from, child_key, to, func, trim, false );
         }
+        else if( nearest_node->second.has_inherited_child( child_key ) ) {
+          insert( to, U( nearest_node->second.get_data() ), child_key, func );
+        }
         child_key = next_key< T, dims >( child_key, 1u );
       }
     }
@@ -1578,16 +2121,72 @@ auto copy(
       assert( ( insert( to, U( nearest_node->second.get_data() ), nearest_node->second.get_range(), func ).second ) );
     }
   }
-  else if( contains< T, dims >( nearest_node->second.get_range(), current_key ) ) {
-    if( nearest_node->second.is_leaf() ) {
-      if( trim )
-        assert( ( insert( to, U( nearest_node->second.get_data() ), current_key, func ).second ) );
-      else
-        insert( to, U( nearest_node->second.get_data() ), nearest_node->second.get_range(), func );
-    }
+  else if( covers( nearest_node->second, current_key ) ) {
+    // the leaf, or the child holding the inherited value
+    const auto leaf_key = nearest_node->second.is_leaf() ?
+      nearest_node->second.get_range() :
+      get_key_in_depth< T, dims >( get_depth< T, dims >( nearest_node->second.get_range() ) - 1u, current_key );
+    if( trim )
+      insert( to, U( nearest_node->second.get_data() ), current_key, func );
+    else
+      insert( to, U( nearest_node->second.get_data() ), leaf_key, func );
   }
 }
 
+// Call func( key, value, overlap ) for each leaf under current_node overlapping range until it returns false.
+// A child holding the inherited value of current_node is given as the leaf of its slot.
+template< HDMapUnderlyingContainer C, typename F >
+bool for_each_leaf_in_rectangle(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  const covering_rectangle_t< C > &range,
+  F &&func
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto overlap = get_overlap_count( to_rectangle< L, dims >( current_node.get_range() ), range );
+  if( overlap == 0u ) return true;
+  if( current_node.is_leaf() ) return func( current_node.get_range(), current_node.get_data(), overlap );
+  if( current_node.is_inherited() ) {
+    return for_each_overlapping_child< T, dims >(
+      current_node.get_range(),
+      range,
+      [&]( T child_key, bool ) {
+        if( current_node.has_inherited_child( child_key ) )
+          return bool( func( child_key, current_node.get_data(), get_overlap_count( to_rectangle< L, dims >( child_key ), range ) ) );
+        if( !current_node.has_child( child_key ) ) return true;
+        const auto child_node = map.find( child_key );
+        assert( child_node != map.end() );
+        return for_each_leaf_in_rectangle( map, child_node->second, range, func );
+      }
+    );
+  }
+  bool continued = true;
+  for_each_child(
+    map,
+    current_node,
+    [&]( const auto &child_node, auto ) {
+      continued = for_each_leaf_in_rectangle( map, child_node->second, range, func );
+      return continued;
+    }
+  );
+  return continued;
+}
+
+template< HDMapUnderlyingContainer C, typename F >
+bool for_each_leaf_in_rectangle(
+  const C &map,
+  const covering_rectangle_t< C > &range,
+  F &&func
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto root_node = map.find( get_root_key< T, dims >() );
+  if( root_node == map.end() ) return true;
+  return for_each_leaf_in_rectangle( map, root_node->second, range, func );
+}
+
 template< HDMapUnderlyingContainer C, typename F >
 auto copy(
   const C &from,
@@ -1596,60 +2195,17 @@ auto copy(
   const F &func,
   bool trim = true
 ) {
-  using T = extract_key_type_t< C >;
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
   using U = extract_value_type_t< C >;
   constexpr auto dims = extract_dims_v< C >;
-  depth_log_t< T, dims > log;
-  auto cached_node = from.end();
-  for_each_in_rectangle_region(
+  for_each_leaf_in_rectangle(
+    from,
     range,
-    [&]( auto ... p ) {
-      const auto key = to_key< T, dims >( 0u, p... );
-      if( cached_node != from.end() ) {
-        if( contains< T, dims >( cached_node->second.get_range(), key ) ) {
-          if( trim )
-            insert( to, U( cached_node->second.get_data() ), key, func );
-        }
-        else {
-          auto root_key = cached_node->first;
-          unsigned int log_pos = log.size();
-          while( !contains< T, dims >( root_key, key ) ) {
-            --log_pos;
-            root_key = get_key_in_depth< T, dims >( log[ log_pos ], root_key );
-          }
-          depth_log_t< T, dims > new_log;
-          auto node = find_nearest( from, root_key, key, new_log );
-          if( node != from.end() ) {
-            if( node->second.is_leaf() ) {
-              if( contains< T, dims >( node->second.get_range(), key ) ) {
-                if( trim )
-                  insert( to, U( node->second.get_data() ), key, func );
-                else 
-                  insert( to, U( node->second.get_data() ), node->second.get_range(), func );
-                log.erase( std::next( log.begin(), log_pos ), log.end() );
-                log.insert( log.end(), new_log.begin(), new_log.end() );
-                cached_node = node;
-              }
-            }
-          }
-        }
-      }
-      else {
-        depth_log_t< T, dims > new_log;
-        auto node = find_nearest( from, get_root_key< T, dims >(), key, new_log );
-        if( node != from.end() ) {
-          if( node->second.is_leaf() ) {
-            if( contains< T, dims >( node->second.get_range(), key ) ) {
-              if( trim )
-                insert( to, U( node->second.get_data() ), key, func );
-              else
-                insert( to, U( node->second.get_data() ), node->second.get_range(), func );
-              log = std::move( new_log );
-              cached_node = node;
-            }
-          }
-        }
-      }
+    [&]( auto leaf_key, const auto &value, auto overlap ) {
+      if( !trim || overlap == get_max_leaf_count< L, dims >( key_cast< L, dims >( leaf_key ) ) )
+        insert( to, U( value ), leaf_key, func );
+      else
+        insert( to, value, leaf_key, range, func );
       return true;
     }
   );
@@ -1665,6 +2221,7 @@ auto move(
   bool is_root = true
 ) {
   using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
   constexpr auto dims = extract_dims_v< C >;
   depth_log_t< T, dims > log;
   auto nearest_node = find_nearest( from, is_root ? get_root_key< T, dims >() : current_key, current_key, log );
@@ -1677,6 +2234,9 @@ auto move(
         if( nearest_node->second.has_child( child_key ) ) {
           copy( from, child_key, to, func, trim, false );
         }
+        else if( nearest_node->second.has_inherited_child( child_key ) ) {
+          insert( to, U( nearest_node->second.get_data() ), child_key, func );
+        }
         child_key = next_key< T, dims >( child_key, 1u );
       }
     }
@@ -1684,6 +2244,11 @@ auto move(
       assert( ( insert( to, std::move( nearest_node->second.move_data() ), nearest_node->second.get_range(), func ).second ) );
     }
   }
+  else if( covers( nearest_node->second, current_key ) && nearest_node->second.is_inherited() ) {
+    // the inherited value is shared with the other children, so it is copied
+    const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( nearest_node->second.get_range() ) - 1u, current_key );
+    insert( to, U( nearest_node->second.get_data() ), trim ? current_key : child_key, func );
+  }
   else if( contains< T, dims >( nearest_node->second.get_range(), current_key ) ) {
     if( nearest_node->second.is_leaf() ) {
       if( trim )
@@ -1742,7 +2307,7 @@ auto get_right_bottom(
   T key
 ) {
   for( unsigned int i = 0u; i != dims; ++i ) {
-    key += 1u << ( i * get_component_bits< T, dims >() );
+    key += T( 1u ) << ( i * get_component_bits< T, dims >() );
   }
   return key;
 }
@@ -1798,12 +2363,15 @@ auto insert(
     }
   }
 
-  auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( current_key ) - 1u, current_key );
   bool inserted = false;
-  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
-    inserted |= insert( map, value, child_key, range, func );
-    child_key = next_key< T, dims >( child_key, 1u );
-  }
+  for_each_covering_key< T, dims >(
+    current_key,
+    range,
+    [&]( T key ) {
+      inserted |= insert( map, U( value ), key, func ).second;
+      return true;
+    }
+  );
   return inserted;
 }
 
@@ -1817,11 +2385,15 @@ auto insert(
   return insert( map, value, get_root_key< extract_key_type_t< C >, extract_dims_v< C > >(), range, func );
 }
 
-template< HDMapUnderlyingContainer C >
+template<
+  HDMapUnderlyingContainer C,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
 auto erase(
   C &map,
   extract_key_type_t< C > current_key,
-  const covering_rectangle_t< C > &range
+  const covering_rectangle_t< C > &range,
+  V &&on_volume = V{}
 ) {
   using rect_t = covering_rectangle_t< C >;
   using L = extract_key_type_t< rect_t >;
@@ -1835,7 +2407,7 @@ auto erase(
       return T( 0u );
     }
     if( overlap == get_max_leaf_count< L, dims >( extended_key_left_top ) ) {
-      return erase( map, current_key );
+      return erase( map, current_key, on_volume );
     }
   }
 
@@ -1854,33 +2426,75 @@ auto erase(
     return T( 0u );
   }
   if( overlap == get_max_leaf_count< L, dims >( extended_key_left_top ) ) {
-    return erase( map, current_node->second.get_range() );
+    return erase( map, current_node->second.get_range(), on_volume );
   }
 
   T erased_count = 0u;
   if( current_node->second.is_leaf() ) {
-    split( map, current_node->second );
+    erased_count += T( split( map, current_node->second, range, on_volume ) );
     current_node = find_nearest( map, get_root_key< T, dims >(), current_key );
     assert( current_node != map.end() );
     assert( !current_node->second.is_leaf() );
+    if( !current_node->second.is_inherited() && current_node->second.get_count() == 1u ) { // keep the path compressed
+      const auto [last_child_node,child_index] = get_child( map, current_node->second );
+      assert( last_child_node != map.end() );
+      current_node->second = std::move( last_child_node->second );
+      map.erase( last_child_node );
+      return T( erased_count + erase( map, current_key, range, on_volume ) );
+    }
   }
-  for_each_child_key(
-    map,
-    current_node->first,
-    [&]( auto &child_key, auto ) {
-      erased_count += erase( map, child_key, range );
+  // erasing a child may collapse current_node, so the children to visit are collected first
+  // The children holding the inherited value become holes if range covers them, and are materialized otherwise.
+  const auto slot_key = current_node->first;
+  const auto node_key = current_node->second.get_range();
+  boost::container::static_vector< std::pair< T, bool >, get_max_child_count< dims >() > children;
+  boost::container::static_vector< T, get_max_child_count< dims >() > inherited_children;
+  for_each_overlapping_child< T, dims >(
+    node_key,
+    range,
+    [&]( T child_key, bool covered ) {
+      if( current_node->second.has_child( child_key ) ) children.push_back( std::make_pair( child_key, covered ) );
+      else if( current_node->second.has_inherited_child( child_key ) ) {
+        if( covered ) {
+          const auto leaves = get_max_leaf_count< T, dims >( child_key );
+          on_volume( current_node->second.get_data(), -std::int64_t( leaves ) );
+          erased_count += leaves;
+          current_node->second.set_hole( child_key );
+        }
+        else inherited_children.push_back( child_key );
+      }
       return true;
     }
   );
+  for( const auto &child_key: inherited_children ) {
+    // the container may relocate current_node on insertion
+    current_node = map.find( slot_key );
+    assert( current_node != map.end() );
+    materialize_child( map, current_node->second, child_key );
+    children.push_back( std::make_pair( child_key, false ) );
+  }
+  for( const auto &[child_key,covered]: children ) {
+    erased_count += covered ? erase( map, child_key, on_volume ) : erase( map, child_key, range, on_volume );
+  }
+  // the children erased may have moved another node to slot_key
+  current_node = map.find( slot_key );
+  if( current_node != map.end() ) {
+    const auto settled_key = current_node->second.get_range();
+    if( settle_inherited( map, slot_key ) ) erase( map, settled_key, on_volume );
+  }
   return erased_count;
 }
 
-template< HDMapUnderlyingContainer C >
+template<
+  HDMapUnderlyingContainer C,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
 auto erase(
   C &map,
-  const covering_rectangle_t< C > &range
+  const covering_rectangle_t< C > &range,
+  V &&on_volume = V{}
 ) {
-  return erase( map, get_root_key< extract_key_type_t< C >, extract_dims_v< C > >(), range );
+  return erase( map, get_root_key< extract_key_type_t< C >, extract_dims_v< C > >(), range, on_volume );
 }
 
 
@@ -1900,16 +2514,345 @@ auto update(
   return rects;
 }
 
+// Merge every internal node below current_node whose children are uniform and drop internal nodes
+// left with a single child, deepest first.
+// A node lying entirely inside one of ranges holds a single leaf, so only the subtrees
+// crossing the border of one of ranges are visited.
+// ranges is reordered so that the rectangles crossing the current subtree come first.
+template< HDMapUnderlyingContainer C, typename F >
+void coalesce(
+  C &map,
+  typename C::iterator current_node,
+  std::span< covering_rectangle_t< C > > ranges,
+  const F &func
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( current_node->second.is_leaf() ) return;
+  const auto node_range = to_rectangle< L, dims >( current_node->second.get_range() );
+  const auto node_size = get_max_leaf_count< L, dims >( node_range.left_top );
+  const auto touched_end = std::partition(
+    ranges.begin(),
+    ranges.end(),
+    [&]( const auto &range ) {
+      const auto overlap = get_overlap_count( node_range, range );
+      return overlap != 0u && overlap != node_size;
+    }
+  );
+  if( touched_end == ranges.begin() ) return;
+  const auto touched = ranges.first( std::distance( ranges.begin(), touched_end ) );
+  // decide from the slot before probing the child, most children lie entirely inside or outside every range
+  for(
+    auto [child_key,child_index] = get_child_key( map, current_node->second );
+    child_index != get_max_child_count< dims >();
+    std::tie( child_key, child_index ) = get_child_key( map, current_node->second, child_index + 1u )
+  ) {
+    const auto slot_range = to_rectangle< L, dims >( child_key );
+    const auto slot_size = get_max_leaf_count< L, dims >( slot_range.left_top );
+    const bool crossed = std::any_of(
+      touched.begin(),
+      touched.end(),
+      [&]( const auto &range ) {
+        const auto overlap = get_overlap_count( slot_range, range );
+        return overlap != 0u && overlap != slot_size;
+      }
+    );
+    if( !crossed ) continue;
+    const auto child_node = map.find( child_key );
+    if( child_node != map.end() ) coalesce( map, child_node, touched, func );
+  }
+  // the children are only erased, so current_node stays valid
+  if( current_node->second.is_inherited() ) {
+    // the leaves equal to the inherited value are dropped, as if they were never materialized
+    const auto &value = current_node->second.get_data();
+    for(
+      auto [child_key,child_index] = get_child_key( map, current_node->second );
+      child_index != get_max_child_count< dims >();
+      std::tie( child_key, child_index ) = get_child_key( map, current_node->second, child_index + 1u )
+    ) {
+      const auto child_node = map.find( child_key );
+      assert( child_node != map.end() );
+      if( child_node->second.is_leaf() && child_node->second.get_range() == child_key && func( value, child_node->second.get_data() ) ) {
+        map.erase( child_node );
+        current_node->second.inherit_child( child_key );
+      }
+    }
+    if( current_node->second.get_inherited_children() == get_camap_mask< dims >() ) { // every child holds the inherited value
+      current_node->second.set_data( U( value ) );
+      return;
+    }
+    if( current_node->second.get_inherited_children() ) return;
+    current_node->second.drop_inherited();
+  }
+  const auto child_count = current_node->second.get_count();
+  if( child_count == 1u ) { // compress the path again
+    const auto [last_child,last_child_index] = get_child( map, current_node->second );
+    assert( last_child != map.end() );
+    current_node->second = std::move( last_child->second );
+    map.erase( last_child );
+    return;
+  }
+  if( child_count != get_max_child_count< dims >() ) return;
+  const auto [first_child,first_child_index] = get_child( map, current_node->second );
+  if( first_child == map.end() || !first_child->second.is_leaf() ) return;
+  auto value = first_child->second.get_data();
+  if( is_uniform_of( map, current_node->second, value, func ) ) {
+    erase_children( map, current_node->first );
+    current_node->second.set_data( std::move( value ) );
+  }
+}
+
+// Give the compressed node stored at slot_key an explicit parent covering the whole slot
+template< HDMapUnderlyingContainer C >
+void expand_slot(
+  C &map,
+  extract_key_type_t< C > slot_key
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto current_node = map.find( slot_key );
+  assert( current_node != map.end() );
+  assert( current_node->second.get_range() != slot_key );
+  const auto child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( slot_key ) - 1u, current_node->second.get_range() );
+  auto child = std::move( current_node->second );
+  current_node->second.reset_to_internal( slot_key );
+  current_node->second.set_child( child_key );
+  // the container may relocate current_node here
+  [[maybe_unused]] const auto insert_result = map.insert( std::make_pair( child_key, std::move( child ) ) );
+  assert( insert_result.second );
+}
+
+// Report the voxels of the subtree under current_node as dropped and erase its descendants
+template< HDMapUnderlyingContainer C, typename V >
+void drop_subtree(
+  C &map,
+  const extract_node_type_t< C > &current_node,
+  V &on_volume
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( current_node.is_leaf() ) on_volume( current_node.get_data(), -std::int64_t( get_max_leaf_count< T, dims >( current_node.get_range() ) ) );
+  else erase_descendants( map, current_node, on_volume );
+}
+
+// Write value to the voxels of range inside the slot slot_key, which must exist.
+// Leaves are overwritten in place where a node is fully covered and only the boundary is split.
+// Nothing is merged here, the caller coalesces once at the end.
+template< HDMapUnderlyingContainer C, typename V >
+void overwrite(
+  C &map,
+  const extract_value_type_t< C > &value,
+  extract_key_type_t< C > slot_key,
+  const covering_rectangle_t< C > &range,
+  V &on_volume
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto slot_range = to_rectangle< L, dims >( slot_key );
+  const auto overlap = get_overlap_count( slot_range, range );
+  if( overlap == 0u ) return;
+  auto current_node = map.find( slot_key );
+  assert( current_node != map.end() );
+  if( overlap == get_max_leaf_count< L, dims >( slot_range.left_top ) ) {
+    drop_subtree( map, current_node->second, on_volume );
+    current_node->second = node< T, U, dims >( slot_key, U( value ) );
+    return;
+  }
+  // a compressed node is only expanded if range reaches the empty part of the slot
+  if( get_overlap_count( to_rectangle< L, dims >( current_node->second.get_range() ), range ) != overlap ) {
+    expand_slot( map, slot_key );
+    current_node = map.find( slot_key );
+    assert( current_node != map.end() );
+  }
+  const auto node_key = current_node->second.get_range();
+  const auto node_range = to_rectangle< L, dims >( node_key );
+  if( overlap == get_max_leaf_count< L, dims >( node_range.left_top ) ) {
+    drop_subtree( map, current_node->second, on_volume );
+    current_node->second = node< T, U, dims >( node_key, U( value ) );
+    return;
+  }
+  if( current_node->second.is_leaf() ) split( map, current_node->second );
+  const auto never_equal = []( const U&, const U& ) { return false; };
+  for_each_overlapping_child< T, dims >(
+    node_key,
+    range,
+    [&]( T child_key, bool covered ) {
+      // inserting may relocate the nodes, so the parent is looked up for each child
+      current_node = map.find( slot_key );
+      assert( current_node != map.end() );
+      if( current_node->second.has_inherited_child( child_key ) ) {
+        if( !covered ) {
+          materialize_child( map, current_node->second, child_key );
+          overwrite( map, value, child_key, range, on_volume );
+          return true;
+        }
+        on_volume( current_node->second.get_data(), -std::int64_t( get_max_leaf_count< T, dims >( child_key ) ) );
+        current_node->second.set_child( child_key );
+        [[maybe_unused]] const auto insert_result = map.insert( std::make_pair( child_key, node< T, U, dims >( child_key, U( value ) ) ) );
+        assert( insert_result.second );
+        return true;
+      }
+      if( current_node->second.has_child( child_key ) ) overwrite( map, value, child_key, range, on_volume );
+      else if( covered ) insert( map, U( value ), child_key, never_equal );
+      else insert( map, value, child_key, range, never_equal );
+      return true;
+    }
+  );
+}
+
+template<
+  HDMapUnderlyingContainer C,
+  typename F,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
+bool overwrite(
+  C &map,
+  const extract_value_type_t< C > &value,
+  covering_rectangle_t< C > range,
+  const F &func,
+  V &&on_volume = V{}
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  constexpr auto root_key = get_root_key< T, dims >();
+  const auto written = get_overlap_count( to_rectangle< L, dims >( root_key ), range );
+  if( written == 0u ) return false;
+  on_volume( value, std::int64_t( written ) );
+  if( map.find( root_key ) == map.end() ) return insert( map, value, range, func );
+  overwrite( map, value, root_key, range, on_volume );
+  coalesce( map, map.find( root_key ), std::span< covering_rectangle_t< C > >( &range, 1u ), func );
+  return true;
+}
+
+// Apply the updates in order, skipping the ones that a later update of the batch overwrites entirely.
+// Only the next batch_lookahead updates are checked, which keeps the cost linear in the batch size.
+// An update overlapping later ones only partially is applied as is, since splitting it into pieces costs more than overwriting the overlap twice.
+template<
+  HDMapUnderlyingContainer C,
+  typename F,
+  std::invocable< const extract_value_type_t< C >&, std::int64_t > V = ignore_volume_change
+>
+void update_batch(
+  C &map,
+  std::span< const std::pair< covering_rectangle_t< C >, extract_value_type_t< C > > > updates,
+  const F &func,
+  V &&on_volume = V{}
+) {
+  constexpr std::size_t batch_lookahead = 64u;
+  for( std::size_t i = 0u; i != updates.size(); ++i ) {
+    const auto &range = updates[ i ].first;
+    const auto volume = get_overlap_count( range, range );
+    const auto end = std::min( updates.size(), i + 1u + batch_lookahead );
+    bool covered = false;
+    for( std::size_t j = i + 1u; j != end && !covered; ++j )
+      covered = get_overlap_count( range, updates[ j ].first ) == volume;
+    if( !covered ) overwrite( map, updates[ i ].second, range, func, on_volume );
+  }
+}
+
 }
 
 namespace views {
   namespace leaf_detail {
     struct leaf_tag {};
-    template< std::ranges::range R >
+    template< typename R >
+    concept has_rect = requires( const R &r ) { r.get_rect(); };
+    // The leaves of the nodes in R, followed by a leaf for each child of an inherited node holding the inherited value.
+    // Each leaf is yielded by value as a pair of the key and a leaf_reference, which stays valid as long as the nodes are not modified.
+    template< std::ranges::view R >
+    class view : public std::ranges::view_interface< view< R > > {
+      using base_iterator = std::ranges::iterator_t< const R >;
+      using base_sentinel = std::ranges::sentinel_t< const R >;
+      using rect_t = detail::covering_rectangle_t< R >;
+      using L = detail::extract_key_type_t< rect_t >;
+      using T = detail::extract_key_type_t< R >;
+      using U = detail::extract_value_type_t< R >;
+      constexpr static auto dims = detail::extract_dims_v< R >;
+    public:
+      class iterator {
+      public:
+        using value_type = std::pair< T, detail::leaf_reference< T, U, dims > >;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        // operator* returns a prvalue, so the iterator is only an input iterator to the algorithms predating ranges
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+        iterator() = default;
+        iterator(
+          base_iterator current_,
+          base_sentinel last_,
+          const std::optional< rect_t > &rect_
+        ) : current( current_ ), last( last_ ), rect( rect_ ) {
+          satisfy();
+        }
+        reference operator*() const {
+          const auto &current_node = current->second;
+          if( synthesized ) return value_type( *synthesized, detail::leaf_reference< T, U, dims >( *synthesized, current_node.get_data() ) );
+          return value_type( current->first, detail::leaf_reference< T, U, dims >( current_node.get_range(), current_node.get_data() ) );
+        }
+        iterator &operator++() {
+          if( !synthesized ) {
+            ++current;
+            next = 0u;
+          }
+          synthesized.reset();
+          satisfy();
+          return *this;
+        }
+        iterator operator++( int ) {
+          auto temp = *this;
+          ++*this;
+          return temp;
+        }
+        bool operator==( const iterator &r ) const {
+          return current == r.current && next == r.next;
+        }
+      private:
+        void satisfy() {
+          for( ; current != last; ++current, next = 0u ) {
+            const auto &current_node = current->second;
+            if( current_node.is_leaf() ) return;
+            if( !current_node.get_inherited_children() ) continue;
+            const auto lower_key = detail::get_key_in_depth< T, dims >( detail::get_depth< T, dims >( current_node.get_range() ) - 1u, current_node.get_range() );
+            for( ; next != detail::get_max_child_count< dims >(); ++next ) {
+              const auto child_key = detail::child_index_to_key< T, dims >( lower_key, next );
+              if( !current_node.has_inherited_child( child_key ) ) continue;
+              if( rect && detail::get_overlap_count( detail::to_rectangle< L, dims >( child_key ), *rect ) == 0u ) continue;
+              synthesized = child_key;
+              ++next;
+              return;
+            }
+          }
+        }
+        base_iterator current{};
+        base_sentinel last{};
+        std::optional< rect_t > rect;
+        unsigned int next = 0u;
+        // the key of the inherited child visited now, if the iterator is on one
+        std::optional< T > synthesized;
+      };
+      view() = default;
+      explicit view( R base_ ) : base( std::move( base_ ) ) {
+        if constexpr ( has_rect< R > ) rect = base.get_rect();
+      }
+      iterator begin() const {
+        return iterator( std::ranges::begin( base ), std::ranges::end( base ), rect );
+      }
+      iterator end() const {
+        return iterator( std::ranges::end( base ), std::ranges::end( base ), rect );
+      }
+    private:
+      R base;
+      // only the inherited children inside rect are visited, if the nodes are the ones intersecting rect
+      std::optional< rect_t > rect;
+    };
+    template< std::ranges::viewable_range R >
     auto operator|( R &&r, leaf_tag ) {
-      return
-        std::forward< R >( r ) |
-        std::views::filter( []( const auto &v ){ return v.second.is_leaf(); } );
+      return view< std::views::all_t< R > >( std::views::all( std::forward< R >( r ) ) );
     }
   }
   inline constexpr auto leaf = leaf_detail::leaf_tag{};
@@ -1987,139 +2930,291 @@ namespace views {
     }
   }
   inline constexpr auto indirect_rectangle_region = indirect_rectangle_region_detail::tag{};
+  namespace intersecting_detail {
+    template< HDMapUnderlyingContainer C >
+    class iterator {
+      using T = detail::extract_key_type_t< C >;
+      using rect_t = detail::covering_rectangle_t< C >;
+      using L = detail::extract_key_type_t< rect_t >;
+      constexpr static auto dims = detail::extract_dims_v< C >;
+      using node_iterator = typename C::const_iterator;
+      using stack_t = boost::container::static_vector<
+        std::pair< node_iterator, unsigned int >,
+        detail::get_max_depth< T, dims >() + 1u
+      >;
+    public:
+      using value_type = typename C::value_type;
+      using difference_type = std::ptrdiff_t;
+      using reference = const value_type&;
+      using pointer = const value_type*;
+      using iterator_category = std::forward_iterator_tag;
+      using iterator_concept = std::forward_iterator_tag;
+      iterator() = default;
+      iterator(
+        const C &map_,
+        const rect_t &rect_
+      ) : map( &map_ ), rect( rect_ ) {
+        const auto root_node = map->find( detail::get_root_key< T, dims >() );
+        if( root_node != map->end() && overlapped( root_node ) )
+          stack.push_back( std::make_pair( root_node, 0u ) );
+      }
+      reference operator*() const {
+        return *stack.back().first;
+      }
+      pointer operator->() const {
+        return &*stack.back().first;
+      }
+      iterator &operator++() {
+        while( !stack.empty() ) {
+          auto &[current_node,next] = stack.back();
+          if( current_node->second.is_leaf() ) {
+            stack.pop_back();
+            continue;
+          }
+          const auto [child_node,child_index] = detail::get_child( *map, current_node->second, next );
+          if( child_node == map->end() ) {
+            stack.pop_back();
+            continue;
+          }
+          next = child_index + 1u;
+          if( overlapped( child_node ) ) {
+            stack.push_back( std::make_pair( child_node, 0u ) );
+            return *this;
+          }
+        }
+        return *this;
+      }
+      iterator operator++( int ) {
+        auto temp = *this;
+        ++*this;
+        return temp;
+      }
+      bool operator==( const iterator &r ) const {
+        if( stack.empty() || r.stack.empty() ) return stack.empty() && r.stack.empty();
+        return stack.back().first == r.stack.back().first;
+      }
+    private:
+      bool overlapped( node_iterator v ) const {
+        return detail::get_overlap_count( detail::to_rectangle< L, dims >( v->second.get_range() ), rect ) != 0u;
+      }
+      const C *map = nullptr;
+      rect_t rect;
+      stack_t stack;
+    };
+    template< HDMapUnderlyingContainer C >
+    class view : public std::ranges::view_interface< view< C > > {
+      using rect_t = detail::covering_rectangle_t< C >;
+    public:
+      view() = default;
+      view(
+        const C &map_,
+        const rect_t &rect_
+      ) : map( &map_ ), rect( rect_ ) {}
+      iterator< C > begin() const {
+        return iterator< C >( *map, rect );
+      }
+      iterator< C > end() const {
+        return iterator< C >();
+      }
+      const rect_t &get_rect() const {
+        return rect;
+      }
+    private:
+      const C *map = nullptr;
+      rect_t rect;
+    };
+  }
+  template< HDMapUnderlyingContainer C >
+  auto intersecting( const C &map, const detail::covering_rectangle_t< C > &rect ) {
+    return intersecting_detail::view< C >( map, rect );
+  }
 }
 
 namespace detail {
 
-template< HDMapUnderlyingContainer C, typename F >
-auto expand_rectangle_positive(
-  C &&map,
-  const covering_rectangle_t< C > &range,
-  unsigned int axis,
-  const extract_value_type_t< C > &value,
+template< std::unsigned_integral T, unsigned int dims >
+bool is_adjacent_along(
+  const rectangle< T, dims > &l,
+  const rectangle< T, dims > &r,
+  unsigned int axis
+) {
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    if( i == axis ) {
+      if( get_component< T, dims >( i, l.right_bottom ) != get_component< T, dims >( i, r.left_top ) ) return false;
+    }
+    else {
+      if( get_component< T, dims >( i, l.left_top ) != get_component< T, dims >( i, r.left_top ) ) return false;
+      if( get_component< T, dims >( i, l.right_bottom ) != get_component< T, dims >( i, r.right_bottom ) ) return false;
+    }
+  }
+  return true;
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+bool merge_if_adjacent(
+  rectangle< T, dims > &tail,
+  const rectangle< T, dims > &rect
+) {
+  for( unsigned int axis = 0u; axis != dims; ++axis ) {
+    if( is_adjacent_along( tail, rect, axis ) ) {
+      set_component< T, dims >( axis, tail.right_bottom, get_component< T, dims >( axis, rect.right_bottom ) );
+      return true;
+    }
+    if( is_adjacent_along( rect, tail, axis ) ) {
+      set_component< T, dims >( axis, tail.left_top, get_component< T, dims >( axis, rect.left_top ) );
+      return true;
+    }
+  }
+  return false;
+}
+
+template< std::unsigned_integral T, unsigned int dims, typename U, typename F >
+void append_rectangle_region(
+  std::vector< std::pair< rectangle< T, dims >, const U* > > &rects,
+  const rectangle< T, dims > &rect,
+  const U &value,
   const F &func
 ) {
-  using T = extract_key_type_t< C >;
-  using L = extract_key_type_t< covering_rectangle_t< C > >;
-  constexpr auto dims = extract_dims_v< C >;
-  auto left_top = get_key_in_depth< L, dims >( 0u, range.left_top );
-  auto right_bottom = get_key_in_depth< L, dims >( 0u, range.right_bottom );
-  if( get_component< L, dims >( axis, right_bottom ) == L( get_component_max< T, dims >() ) + 1u ) return range;
-  set_component< L, dims >( axis, left_top, get_component< L, dims >( axis, right_bottom ) );
-  set_component< L, dims >( axis, right_bottom, get_component< L, dims >( axis, right_bottom ) + 1u );
-  std::remove_cvref_t< C > overlap;
-  while( get_component< L, dims >( axis, left_top ) <= L( get_component_max< T, dims >() ) + 1u ) {
-    overlap.clear();
-    copy( map, rectangle< L, dims >{ left_top, right_bottom }, overlap, func, false );
-    const auto [uniform,min,max] = is_uniform_of( overlap|views::leaf, rectangle< L, dims >{ left_top, right_bottom }, value, axis, func );
-    if( !uniform ) break;
-    set_component< L, dims >( axis, left_top, max );
-    set_component< L, dims >( axis, right_bottom, max + 1u );
-  }
-  set_component< L, dims >( axis, right_bottom, get_component< L, dims >( axis, left_top ) );
-  return rectangle< L, dims >{ range.left_top, right_bottom };
+  if( !rects.empty() && func( *rects.back().second, value ) && merge_if_adjacent( rects.back().first, rect ) ) return;
+  rects.emplace_back( rect, &value );
 }
 
-template< HDMapUnderlyingContainer C, typename F >
-auto expand_rectangle_negative(
-  C &&map,
-  const covering_rectangle_t< C > &range,
+template< std::unsigned_integral T, unsigned int dims, typename U, typename F >
+bool merge_rectangle_regions(
+  std::vector< std::pair< rectangle< T, dims >, const U* > > &rects,
   unsigned int axis,
-  const extract_value_type_t< C > &value,
   const F &func
 ) {
-  using L = extract_key_type_t< covering_rectangle_t< C > >;
-  constexpr auto dims = extract_dims_v< C >;
-  auto left_top = get_key_in_depth< L, dims >( 0u, range.left_top );
-  auto right_bottom = get_key_in_depth< L, dims >( 0u, range.right_bottom );
-  if( get_component< L, dims >( axis, left_top ) <= 0u ) return range;
-  set_component< L, dims >( axis, right_bottom, get_component< L, dims >( axis, left_top ) );
-  set_component< L, dims >( axis, left_top, get_component< L, dims >( axis, left_top ) - 1u );
-  std::remove_cvref_t< C > overlap;
-  while( get_component< L, dims >( axis, right_bottom ) > 0u ) {
-    overlap.clear();
-    copy( map, rectangle< L, dims >{ left_top, right_bottom }, overlap, func, false );
-    const auto [uniform,min,max] = is_uniform_of( overlap|views::leaf, rectangle< L, dims >{ left_top, right_bottom }, value, axis, func );
-    if( !uniform ) break;
-    set_component< L, dims >( axis, left_top, min - 1u );
-    set_component< L, dims >( axis, right_bottom, min );
-  }
-  set_component< L, dims >( axis, left_top, get_component< L, dims >( axis, right_bottom ) );
-  return rectangle< L, dims >{ left_top, range.right_bottom };
+  if( rects.empty() ) return false;
+  std::sort(
+    rects.begin(),
+    rects.end(),
+    [axis]( const auto &l, const auto &r ) {
+      for( unsigned int i = 0u; i != dims; ++i ) {
+        if( i == axis ) continue;
+        const auto l_begin = get_component< T, dims >( i, l.first.left_top );
+        const auto r_begin = get_component< T, dims >( i, r.first.left_top );
+        if( l_begin != r_begin ) return l_begin < r_begin;
+        const auto l_end = get_component< T, dims >( i, l.first.right_bottom );
+        const auto r_end = get_component< T, dims >( i, r.first.right_bottom );
+        if( l_end != r_end ) return l_end < r_end;
+      }
+      return get_component< T, dims >( axis, l.first.left_top ) < get_component< T, dims >( axis, r.first.left_top );
+    }
+  );
+  bool merged = false;
+  auto tail = rects.begin();
+  for( auto iter = std::next( rects.begin() ); iter != rects.end(); ++iter ) {
+    if( is_adjacent_along( tail->first, iter->first, axis ) && func( *tail->second, *iter->second ) ) {
+      set_component< T, dims >( axis, tail->first.right_bottom, get_component< T, dims >( axis, iter->first.right_bottom ) );
+      merged = true;
+    }
+    else {
+      *++tail = *iter;
+    }
+  }
+  rects.erase( std::next( tail ), rects.end() );
+  return merged;
 }
 
-template< std::unsigned_integral T, unsigned int dims >
-rectangle< T, dims > operator&(
-  const rectangle< T, dims > &l,
-  const rectangle< T, dims > &r
+template< HDMapUnderlyingContainer C, typename F >
+auto decompose_rectangle_regions(
+  const C &map,
+  const covering_rectangle_t< C > &range,
+  const F &func,
+  decomposition_mode_t mode = decomposition_mode_t::FEWEST
 ) {
-  rectangle< T, dims > temp;
-  for( unsigned int i = 0u; i != dims; ++i ) {
-    set_component< T, dims >( i, temp.left_top, std::max( get_component< T, dims >( i, l.left_top ), get_component< T, dims >( i, r.left_top ) ) );
-    set_component< T, dims >( i, temp.right_bottom, std::min( get_component< T, dims >( i, l.right_bottom ), get_component< T, dims >( i, r.right_bottom ) ) );
-    if( get_component< T, dims >( i, temp.left_top ) >= get_component< T, dims >( i, temp.right_bottom ) )
-      return rectangle< T, dims >{};
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  std::vector< std::pair< rectangle< L, dims >, const U* > > rects;
+  for_each_leaf_in_rectangle(
+    map,
+    range,
+    [&]( auto leaf_key, const auto &value, auto ) {
+      append_rectangle_region( rects, to_rectangle< L, dims >( leaf_key ) & range, value, func );
+      return true;
+    }
+  );
+  if( mode == decomposition_mode_t::FEWEST ) {
+    bool merged = true;
+    while( merged ) {
+      merged = false;
+      for( unsigned int axis = 0u; axis != dims; ++axis ) {
+        merged |= merge_rectangle_regions( rects, axis, func );
+      }
+    }
   }
-  return temp;
+  return rects;
 }
 
-template< HDMapUnderlyingContainer C, typename F >
-auto expand_rectangle(
-  C &&map,
-  const F &func
+template< HDMapUnderlyingContainer C, typename F, typename G >
+void for_each_rectangle_region(
+  const C &map,
+  const covering_rectangle_t< C > &range,
+  const F &func,
+  G &&cb,
+  decomposition_mode_t mode = decomposition_mode_t::FEWEST
 ) {
   using L = extract_key_type_t< covering_rectangle_t< C > >;
   using U = extract_value_type_t< C >;
   constexpr auto dims = extract_dims_v< C >;
-  if( map.empty() ) return std::make_pair( covering_rectangle_t< C >{}, U() );
-  auto view = map|views::leaf;
-  const auto begin = std::ranges::begin( view );
-  assert( std::ranges::distance( view ) != 0 );
-  const auto left_top = key_cast< L, dims >( begin->second.get_range() );
-  const auto right_bottom = get_right_bottom< L, dims >( left_top );
-  auto rect = covering_rectangle_t< C >{
-    left_top,
-    right_bottom
-  };
-  for( unsigned int i = 0u; i != dims; ++i ) {
-    rect = expand_rectangle_positive( map, rect, i, begin->second.get_data(), func );
-    rect = expand_rectangle_negative( map, rect, i, begin->second.get_data(), func );
+  if( mode == decomposition_mode_t::FEWEST ) {
+    for( const auto &[rect,value]: decompose_rectangle_regions( map, range, func, mode ) ) {
+      cb( rect, *value );
+    }
+    return;
   }
-  return std::make_pair( rect, begin->second.get_data() );
+  rectangle< L, dims > pending_rect;
+  const U *pending_value = nullptr;
+  for_each_leaf_in_rectangle(
+    map,
+    range,
+    [&]( auto leaf_key, const auto &value, auto ) {
+      const auto rect = to_rectangle< L, dims >( leaf_key ) & range;
+      if( pending_value && func( *pending_value, value ) && merge_if_adjacent( pending_rect, rect ) ) return true;
+      if( pending_value ) cb( std::as_const( pending_rect ), *pending_value );
+      pending_rect = rect;
+      pending_value = &value;
+      return true;
+    }
+  );
+  if( pending_value ) cb( std::as_const( pending_rect ), *pending_value );
 }
 
 template< HDMapUnderlyingContainer C, typename F >
 auto convert_to_rectangle_regions(
-  C &&map,
+  const C &map,
   const covering_rectangle_t< C > &range,
   std::vector< std::pair< covering_rectangle_t< C >, extract_value_type_t< C > > > &rects,
-  const F &func
+  const F &func,
+  decomposition_mode_t mode = decomposition_mode_t::FEWEST
 ) {
-  using L = extract_key_type_t< covering_rectangle_t< C > >;
-  constexpr auto dims = extract_dims_v< C >;
-  while( !map.empty() ) {
-    auto [rect,value] = expand_rectangle( map, func );
-    auto inner_rect =  rect & range;
-    if( get_max_leaf_count< L, dims >( inner_rect ) )
-      rects.emplace_back( rect & range, value );
-    erase( map, rect );
-  }
+  for_each_rectangle_region(
+    map,
+    range,
+    func,
+    [&]( const auto &rect, const auto &value ) {
+      rects.emplace_back( rect, value );
+    },
+    mode
+  );
 }
 
 template< HDMapUnderlyingContainer C, typename F >
 auto convert_to_rectangle_regions(
-  C &&map,
+  const C &map,
   const covering_rectangle_t< C > &range,
-  const F &func
+  const F &func,
+  decomposition_mode_t mode = decomposition_mode_t::FEWEST
 ) {
   using L = extract_key_type_t< covering_rectangle_t< C > >;
   using U = extract_value_type_t< C >;
   constexpr auto dims = extract_dims_v< C >;
   std::vector< std::pair< rectangle< L, dims >, U > > rects;
-  convert_to_rectangle_regions( std::forward< C >( map ), range, rects, func );
+  convert_to_rectangle_regions( map, range, rects, func, mode );
   return rects;
 }
-
 }
 
 template<
@@ -2138,12 +3233,320 @@ using standard_underlying_container_t = std::unordered_map<
   Allocator
 >;
 
+// Aggregate policies are monoids over the voxels of a map.
+// identity() is the aggregate of no voxel, leaf( value, n ) the aggregate of n voxels holding value
+// and combine( l, r ) joins the aggregates of two disjoint sets of voxels.
+struct no_aggregate {};
+
+struct count_aggregate {
+  using type = std::size_t;
+  type identity() const {
+    return 0u;
+  }
+  template< typename U >
+  type leaf( const U&, std::size_t voxels ) const {
+    return voxels;
+  }
+  type combine( type l, type r ) const {
+    return l + r;
+  }
+};
+
+template< typename U >
+struct sum_aggregate {
+  using type = U;
+  type identity() const {
+    return U{};
+  }
+  type leaf( const U &value, std::size_t voxels ) const {
+    return value * U( voxels );
+  }
+  type combine( const type &l, const type &r ) const {
+    return l + r;
+  }
+};
+
+template< typename U, typename Compare = std::less< U > >
+struct min_aggregate {
+  using type = std::optional< U >;
+  type identity() const {
+    return std::nullopt;
+  }
+  type leaf( const U &value, std::size_t ) const {
+    return value;
+  }
+  type combine( const type &l, const type &r ) const {
+    if( !l ) return r;
+    if( !r ) return l;
+    return Compare{}( *r, *l ) ? r : l;
+  }
+};
+
+template< typename U, typename Compare = std::less< U > >
+struct max_aggregate {
+  using type = std::optional< U >;
+  type identity() const {
+    return std::nullopt;
+  }
+  type leaf( const U &value, std::size_t ) const {
+    return value;
+  }
+  type combine( const type &l, const type &r ) const {
+    if( !l ) return r;
+    if( !r ) return l;
+    return Compare{}( *l, *r ) ? r : l;
+  }
+};
+
+namespace detail {
+
+// The aggregates of the internal nodes keyed by node range, which stays the same when a node is moved to another slot
+template< typename T, typename A >
+struct aggregate_table {
+  std::unordered_map< T, typename A::type > values;
+};
+template< typename T >
+struct aggregate_table< T, no_aggregate > {};
+
+template< HDMapUnderlyingContainer C, typename A >
+typename A::type get_aggregate(
+  const extract_node_type_t< C > &current_node,
+  const A &op,
+  const std::unordered_map< extract_key_type_t< C >, typename A::type > &table
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( current_node.is_leaf() ) return op.leaf( current_node.get_data(), std::size_t( get_max_leaf_count< L, dims >( key_cast< L, dims >( current_node.get_range() ) ) ) );
+  const auto cached = table.find( current_node.get_range() );
+  assert( cached != table.end() );
+  return cached->second;
+}
+
+// Recompute the aggregate of current_node after those of the children for which descend( child ) is true
+// The internal children without aggregate are always computed
+template< HDMapUnderlyingContainer C, typename A, typename F >
+void refresh_aggregates(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  const A &op,
+  std::unordered_map< extract_key_type_t< C >, typename A::type > &table,
+  const F &descend
+) {
+  if( current_node.is_leaf() ) return;
+  auto value = op.identity();
+  for_each_child(
+    map,
+    current_node,
+    [&]( const auto &child_node, auto ) {
+      if( !child_node->second.is_leaf() && ( descend( child_node->second ) || !table.contains( child_node->second.get_range() ) ) )
+        refresh_aggregates( map, child_node->second, op, table, descend );
+      value = op.combine( value, get_aggregate< C >( child_node->second, op, table ) );
+      return true;
+    }
+  );
+  if( const auto inherited = current_node.get_inherited_children() ) {
+    using L = extract_key_type_t< covering_rectangle_t< C > >;
+    constexpr auto dims = extract_dims_v< C >;
+    const auto child_size = get_max_leaf_count< L, dims >( key_cast< L, dims >( current_node.get_range() ) ) / get_max_child_count< dims >();
+    value = op.combine( value, op.leaf( current_node.get_data(), std::size_t( std::popcount( inherited ) * child_size ) ) );
+  }
+  table.insert_or_assign( current_node.get_range(), std::move( value ) );
+}
+
+// The aggregate of the voxels of range under current_node
+// The cached aggregate is used for the internal nodes inside range if table is not nullptr
+template< HDMapUnderlyingContainer C, typename A >
+typename A::type reduce(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  const covering_rectangle_t< C > &range,
+  const A &op,
+  const std::unordered_map< extract_key_type_t< C >, typename A::type > *table
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto node_range = to_rectangle< L, dims >( current_node.get_range() );
+  const auto overlap = get_overlap_count( node_range, range );
+  if( overlap == 0u ) return op.identity();
+  if( current_node.is_leaf() ) return op.leaf( current_node.get_data(), std::size_t( overlap ) );
+  if( table && overlap == get_max_leaf_count< L, dims >( node_range.left_top ) ) return get_aggregate< C >( current_node, op, *table );
+  auto value = op.identity();
+  for_each_overlapping_child< T, dims >(
+    current_node.get_range(),
+    range,
+    [&]( T child_key, bool ) {
+      if( current_node.has_inherited_child( child_key ) ) {
+        value = op.combine( value, op.leaf( current_node.get_data(), std::size_t( get_overlap_count( to_rectangle< L, dims >( child_key ), range ) ) ) );
+        return true;
+      }
+      if( !current_node.has_child( child_key ) ) return true;
+      const auto child_node = map.find( child_key );
+      assert( child_node != map.end() );
+      value = op.combine( value, reduce( map, child_node->second, range, op, table ) );
+      return true;
+    }
+  );
+  return value;
+}
+
+// The number of voxels of range under current_node holding a value satisfying pred
+template< HDMapUnderlyingContainer C, typename F >
+std::size_t count_if(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  const covering_rectangle_t< C > &range,
+  const F &pred
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto overlap = get_overlap_count( to_rectangle< L, dims >( current_node.get_range() ), range );
+  if( overlap == 0u ) return 0u;
+  if( current_node.is_leaf() ) return pred( current_node.get_data() ) ? std::size_t( overlap ) : 0u;
+  std::size_t count = 0u;
+  for_each_overlapping_child< T, dims >(
+    current_node.get_range(),
+    range,
+    [&]( T child_key, bool ) {
+      if( current_node.has_inherited_child( child_key ) ) {
+        if( pred( current_node.get_data() ) ) count += std::size_t( get_overlap_count( to_rectangle< L, dims >( child_key ), range ) );
+        return true;
+      }
+      if( !current_node.has_child( child_key ) ) return true;
+      const auto child_node = map.find( child_key );
+      assert( child_node != map.end() );
+      count += count_if( map, child_node->second, range, pred );
+      return true;
+    }
+  );
+  return count;
+}
+
+// Whether range contains any voxel under current_node
+// An internal node always has a leaf, so the search stops at the first node overlapping range that is a leaf or is inside range
+template< HDMapUnderlyingContainer C >
+bool any(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  const covering_rectangle_t< C > &range
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto node_range = to_rectangle< L, dims >( current_node.get_range() );
+  const auto overlap = get_overlap_count( node_range, range );
+  if( overlap == 0u ) return false;
+  if( current_node.is_leaf() || overlap == get_max_leaf_count< L, dims >( node_range.left_top ) ) return true;
+  return !for_each_overlapping_child< T, dims >(
+    current_node.get_range(),
+    range,
+    [&]( T child_key, bool ) {
+      if( current_node.has_inherited_child( child_key ) ) return false;
+      if( !current_node.has_child( child_key ) ) return true;
+      const auto child_node = map.find( child_key );
+      assert( child_node != map.end() );
+      return !any( map, child_node->second, range );
+    }
+  );
+}
+
+// Fill the voxels of box with value. The voxel ( x0, x1, ... ) is dest[ ( x0 - range.left_top[ 0 ] ) * strides[ 0 ] + ... ].
+// A row along the first axis is filled at once, which becomes a run of wide stores if strides[ 0 ] is 1.
+template< std::unsigned_integral L, unsigned int dims, typename U >
+void fill_box(
+  const rectangle< L, dims > &box,
+  const U &value,
+  U *dest,
+  const std::array< std::size_t, dims > &strides,
+  const rectangle< L, dims > &range
+) {
+  std::array< std::size_t, dims > begin;
+  std::array< std::size_t, dims > end;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    begin[ i ] = get_component< L, dims >( i, box.left_top ) - get_component< L, dims >( i, range.left_top );
+    end[ i ] = get_component< L, dims >( i, box.right_bottom ) - get_component< L, dims >( i, range.left_top );
+    if( begin[ i ] >= end[ i ] ) return;
+  }
+  const auto length = end[ 0 ] - begin[ 0 ];
+  auto position = begin;
+  while( true ) {
+    std::size_t offset = 0u;
+    for( unsigned int i = 0u; i != dims; ++i ) offset += position[ i ] * strides[ i ];
+    if( strides[ 0 ] == 1u ) std::fill_n( dest + offset, length, value );
+    else {
+      for( std::size_t i = 0u; i != length; ++i ) dest[ offset + i * strides[ 0 ] ] = value;
+    }
+    unsigned int i = 1u;
+    for( ; i < dims; ++i ) {
+      if( ++position[ i ] != end[ i ] ) break;
+      position[ i ] = begin[ i ];
+    }
+    if( i >= dims ) return;
+  }
+}
+
+// Write the voxels of slot_key inside range to dest, given the node standing for the slot, which is nullptr if the slot is empty.
+// The part of the slot outside a node moved up from below is empty.
+template< HDMapUnderlyingContainer C >
+void rasterize(
+  const C &map,
+  const extract_node_type_t< C > *current_node,
+  extract_key_type_t< C > slot_key,
+  const covering_rectangle_t< C > &range,
+  extract_value_type_t< C > *dest,
+  const std::array< std::size_t, extract_dims_v< C > > &strides,
+  const extract_value_type_t< C > &background
+) {
+  using L = extract_key_type_t< covering_rectangle_t< C > >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto slot_range = to_rectangle< L, dims >( slot_key ) & range;
+  if( get_overlap_count( slot_range, range ) == 0u ) return;
+  if( !current_node ) {
+    fill_box< L, dims >( slot_range, background, dest, strides, range );
+    return;
+  }
+  if( current_node->get_range() != slot_key ) {
+    subtract_rectangle(
+      slot_range,
+      to_rectangle< L, dims >( current_node->get_range() ),
+      [&]( const auto &empty ) { fill_box< L, dims >( empty, background, dest, strides, range ); }
+    );
+  }
+  if( current_node->is_leaf() ) {
+    fill_box< L, dims >( to_rectangle< L, dims >( current_node->get_range() ) & range, current_node->get_data(), dest, strides, range );
+    return;
+  }
+  for_each_overlapping_child< T, dims >(
+    current_node->get_range(),
+    range,
+    [&]( T child_key, bool ) {
+      if( current_node->has_inherited_child( child_key ) ) {
+        fill_box< L, dims >( to_rectangle< L, dims >( child_key ) & range, current_node->get_data(), dest, strides, range );
+        return true;
+      }
+      if( !current_node->has_child( child_key ) ) {
+        rasterize( map, static_cast< const extract_node_type_t< C >* >( nullptr ), child_key, range, dest, strides, background );
+        return true;
+      }
+      const auto child_node = map.find( child_key );
+      assert( child_node != map.end() );
+      rasterize( map, &child_node->second, child_key, range, dest, strides, background );
+      return true;
+    }
+  );
+}
+
+}
+
 template<
   std::unsigned_integral T,
   typename U,
   unsigned int dims,
   std::regular_invocable< const U&, const U& > EqualTo = std::equal_to< U >,
-  HDMapUnderlyingContainer C = standard_underlying_container_t< T, U, dims >
+  HDMapUnderlyingContainer C = standard_underlying_container_t< T, U, dims >,
+  typename Aggregate = no_aggregate
 >
 class hdmap {
 public:
@@ -2153,10 +3556,14 @@ public:
   using value_type = std::pair< rect_type, mapped_type >;
   hdmap(
     EqualTo &&equal_to_ = EqualTo{},
-    C &&map_ = C{}
+    C &&map_ = C{},
+    Aggregate &&aggregate_ = Aggregate{}
   ) :
     equal_to( std::move( equal_to_ ) ),
-    map( std::move( map_ ) ) {
+    map( std::move( map_ ) ),
+    aggregate( std::move( aggregate_ ) ) {
+    for( const auto &v: leaves() ) voxel_count += detail::get_max_leaf_count( v.first );
+    rebuild_aggregates();
   }
   hdmap( const hdmap& ) = default;
   hdmap( hdmap&& ) = default;
@@ -2178,31 +3585,82 @@ public:
   auto erase(
     const rect_type &range
   ) {
-    return detail::erase( map, range );
+    const auto erased = detail::erase( map, range, volume_tracker() );
+    refresh_aggregates( range );
+    return erased;
   }
   auto find(
     const rect_type &range,
-    std::vector< value_type > &dest
+    std::vector< value_type > &dest,
+    decomposition_mode_t mode = decomposition_mode_t::FEWEST
   ) const {
-    C affected;
-    detail::copy( map, range, affected, equal_to, false );
-    detail::convert_to_rectangle_regions( affected, range, dest, equal_to );
+    detail::convert_to_rectangle_regions( map, range, dest, equal_to, mode );
+  }
+  template< std::invocable< const rect_type&, const U& > F >
+  void find(
+    const rect_type &range,
+    F &&cb,
+    decomposition_mode_t mode = decomposition_mode_t::FEWEST
+  ) const {
+    detail::for_each_rectangle_region( map, range, equal_to, std::forward< F >( cb ), mode );
+  }
+  // dest[ i ] points to the value of the voxel points[ i ], or is nullptr if the voxel is empty
+  // The pointers are valid until the map is modified
+  void find_points(
+    std::span< const key_type > points,
+    std::span< const U* > dest
+  ) const {
+    assert( dest.size() >= points.size() );
+    std::vector< T > keys;
+    std::vector< std::size_t > indices;
+    keys.reserve( points.size() );
+    indices.reserve( points.size() );
+    for( std::size_t i = 0u; i != points.size(); ++i ) {
+      dest[ i ] = nullptr;
+      bool in_range = true;
+      for( unsigned int j = 0u; j != dims; ++j ) {
+        if( detail::get_component< key_type, dims >( j, points[ i ] ) > key_type( detail::get_component_max< T, dims >() ) ) in_range = false;
+      }
+      if( in_range ) {
+        keys.push_back( key_cast< T, dims >( points[ i ] ) );
+        indices.push_back( i );
+      }
+    }
+    const C &cmap = map;
+    detail::find_points(
+      cmap,
+      std::span< const T >( keys ),
+      [&]( std::size_t index, const auto &node ) {
+        if( node != cmap.end() ) dest[ indices[ index ] ] = &node->second.get_data();
+      }
+    );
+  }
+  // Same result as calling update for each element in order
+  void update_batch(
+    std::span< const value_type > updates
+  ) {
+    detail::update_batch( map, updates, equal_to, volume_tracker() );
+    for( const auto &v: updates ) refresh_aggregates( v.first );
   }
   auto update(
     const rect_type &range,
     U &&value
   ) {
-    detail::erase( map, range );
-    return detail::insert( map, std::move( value ), range, equal_to );
+    const auto updated = detail::overwrite( map, value, range, equal_to, volume_tracker() );
+    refresh_aggregates( range );
+    return updated;
   }
   auto all(
-    std::vector< value_type > &dest
-  ) {
-    C affected = map;
-    detail::convert_to_rectangle_regions( affected, rect_type{ detail::get_root_key< key_type, dims >(), detail::get_right_bottom< key_type, dims >( detail::get_root_key< key_type, dims >() ) }, dest, equal_to );
+    std::vector< value_type > &dest,
+    decomposition_mode_t mode = decomposition_mode_t::FEWEST
+  ) const {
+    detail::convert_to_rectangle_regions( map, rect_type{ detail::get_root_key< key_type, dims >(), detail::get_right_bottom< key_type, dims >( detail::get_root_key< key_type, dims >() ) }, dest, equal_to, mode );
   }
   void clear() {
     map.clear();
+    voxel_count = 0u;
+    if( volumes ) volumes->clear();
+    if constexpr ( has_aggregate ) aggregates.values.clear();
   }
   bool empty() const {
     return map.empty();
@@ -2210,17 +3668,108 @@ public:
   const C &nodes() const {
     return map;
   }
+  // A copy of the map which is not affected by the later modifications.
+  // With persistent_underlying_container_t the nodes are shared until either side modifies them, so this takes constant time except for the volumes and the aggregates, which are copied when enabled.
+  // The snapshot can be read from another thread while this map is modified, but it has to be taken on the thread modifying this map.
+  hdmap snapshot() const {
+    return *this;
+  }
   auto leaves() const {
     return map|views::leaf|views::node;
   }
-  auto size() const {
-    auto l = leaves();
+  auto leaves( const rect_type &range ) const {
+    return views::intersecting( map, range )|views::leaf|views::node;
+  }
+  // The number of non empty voxels, maintained by every modification
+  std::size_t size() const {
+    return voxel_count;
+  }
+  // Keep the number of voxels holding each distinct value from now on.
+  // The counts are kept in a list searched with value_eq, so this is meant for maps with a small value domain.
+  void enable_volumes() {
+    if( volumes ) return;
+    volumes.emplace();
+    for( const auto &v: leaves() ) add_volume( v.second, std::int64_t( detail::get_max_leaf_count( v.first ) ) );
+  }
+  bool volumes_enabled() const {
+    return bool( volumes );
+  }
+  // The number of voxels holding a value equal to value, in constant time for each distinct value if volumes are enabled
+  std::size_t volume( const U &value ) const {
+    if( volumes ) {
+      const auto existing = std::find_if( volumes->begin(), volumes->end(), [&]( const auto &v ) { return equal_to( v.first, value ); } );
+      return existing != volumes->end() ? existing->second : 0u;
+    }
     std::size_t sum = 0u;
-    for( const auto &v: l ) {
-      sum += detail::get_max_leaf_count( v.first );
+    for( const auto &v: leaves() ) {
+      if( equal_to( v.second, value ) ) sum += detail::get_max_leaf_count( v.first );
     }
     return sum;
   }
+  // Combine the voxels of range with the map's Aggregate policy.
+  // The subtrees inside range use the cached aggregates, so only the nodes on the border of range are visited.
+  auto reduce(
+    const rect_type &range
+  ) const requires( !std::is_same_v< Aggregate, no_aggregate > ) {
+    const auto root_node = map.find( detail::get_root_key< T, dims >() );
+    if( root_node == map.end() ) return aggregate.identity();
+    return detail::reduce( map, root_node->second, range, aggregate, &aggregates.values );
+  }
+  // Combine the voxels of range with an arbitrary aggregate policy op.
+  // Nothing is cached for op, so every leaf overlapping range is visited.
+  template< typename A >
+  typename A::type reduce(
+    const rect_type &range,
+    const A &op
+  ) const {
+    const auto root_node = map.find( detail::get_root_key< T, dims >() );
+    if( root_node == map.end() ) return op.identity();
+    return detail::reduce< C, A >( map, root_node->second, range, op, nullptr );
+  }
+  // The number of non empty voxels in range, without allocating
+  std::size_t count(
+    const rect_type &range
+  ) const {
+    if constexpr ( std::is_same_v< Aggregate, count_aggregate > ) return reduce( range );
+    else return count_if( range, []( const U& ) { return true; } );
+  }
+  // The number of voxels in range holding a value satisfying pred, without allocating
+  template< std::predicate< const U& > F >
+  std::size_t count_if(
+    const rect_type &range,
+    F &&pred
+  ) const {
+    const auto root_node = map.find( detail::get_root_key< T, dims >() );
+    if( root_node == map.end() ) return 0u;
+    return detail::count_if( map, root_node->second, range, pred );
+  }
+  // Whether range contains a non empty voxel, without allocating
+  bool any(
+    const rect_type &range
+  ) const {
+    const auto root_node = map.find( detail::get_root_key< T, dims >() );
+    if( root_node == map.end() ) return false;
+    return detail::any( map, root_node->second, range );
+  }
+  // Write the value of each voxel of range to dest, or background if the voxel is empty.
+  // The voxel ( x0, x1, ... ) goes to dest[ ( x0 - range.left_top[ 0 ] ) * strides[ 0 ] + ... ], so a 2D slice of a 3D map is a range one voxel thick, whose stride is not used.
+  // Each leaf and empty slot overlapping range is written a row at a time, and each voxel is written once.
+  void rasterize(
+    const rect_type &range,
+    U *dest,
+    const std::array< std::size_t, dims > &strides,
+    const U &background
+  ) const {
+    constexpr auto root_key = detail::get_root_key< T, dims >();
+    const auto root_range = detail::to_rectangle< key_type, dims >( root_key );
+    detail::subtract_rectangle(
+      range,
+      root_range,
+      [&]( const auto &outside ) { detail::fill_box< key_type, dims >( outside, background, dest, strides, range ); }
+    );
+    const auto root_node = map.find( root_key );
+    detail::rasterize( map, root_node != map.end() ? &root_node->second : nullptr, root_key, range, dest, strides, background );
+  }
   auto hash_function() const {
     return map.hash_function();
   }
@@ -2231,8 +3780,61 @@ public:
     return equal_to;
   }
 private:
+  static constexpr bool has_aggregate = !std::is_same_v< Aggregate, no_aggregate >;
+  // Only the nodes overlapping a modified range can have changed, and after a modification
+  // the internal ones among them are those crossing the border of the range, except for the ones
+  // an update_batch splits again later.
+  // The nodes that got removed or turned into leaves leave stale entries, which are dropped by rebuilding once they pile up.
+  void refresh_aggregates( const rect_type &range ) {
+    if constexpr ( has_aggregate ) {
+      if( aggregates.values.size() > map.size() * 2u + 64u ) {
+        rebuild_aggregates();
+        return;
+      }
+      const auto root_node = map.find( detail::get_root_key< T, dims >() );
+      if( root_node == map.end() ) return;
+      detail::refresh_aggregates(
+        map,
+        root_node->second,
+        aggregate,
+        aggregates.values,
+        [&]( const auto &child_node ) {
+          return detail::get_overlap_count( detail::to_rectangle< key_type, dims >( child_node.get_range() ), range ) != 0u;
+        }
+      );
+    }
+  }
+  void rebuild_aggregates() {
+    if constexpr ( has_aggregate ) {
+      aggregates.values.clear();
+      const auto root_node = map.find( detail::get_root_key< T, dims >() );
+      if( root_node == map.end() ) return;
+      detail::refresh_aggregates( map, root_node->second, aggregate, aggregates.values, []( const auto& ) { return true; } );
+    }
+  }
+  auto volume_tracker() {
+    return [this]( const U &value, std::int64_t delta ) {
+      voxel_count += delta;
+      if( volumes ) add_volume( value, delta );
+    };
+  }
+  void add_volume( const U &value, std::int64_t delta ) {
+    const auto existing = std::find_if( volumes->begin(), volumes->end(), [&]( const auto &v ) { return equal_to( v.first, value ); } );
+    if( existing == volumes->end() ) {
+      assert( delta > 0 );
+      volumes->emplace_back( value, std::size_t( delta ) );
+    }
+    else {
+      existing->second += delta;
+      if( existing->second == 0u ) volumes->erase( existing );
+    }
+  }
   EqualTo equal_to;
-  mutable C map;
+  C map;
+  std::size_t voxel_count = 0u;
+  std::optional< std::vector< std::pair< U, std::size_t > > > volumes;
+  [[no_unique_address]] Aggregate aggregate;
+  [[no_unique_address]] detail::aggregate_table< T, Aggregate > aggregates;
 };
 
 template< typename T >
@@ -2242,9 +3844,10 @@ template<
   typename U,
   unsigned int dims,
   std::regular_invocable< const U&, const U& > EqualTo,
-  HDMapUnderlyingContainer C
+  HDMapUnderlyingContainer C,
+  typename Aggregate
 >
-struct is_hdmap< hdmap< T, U, dims, EqualTo, C > > : public std::true_type {};
+struct is_hdmap< hdmap< T, U, dims, EqualTo, C, Aggregate > > : public std::true_type {};
 template< typename T >
 constexpr bool is_hdmap_v = is_hdmap< T >::value;
 template< typename T >
@@ -57,10 +57,14 @@ void to_json(
     root[ "value" ] = node.get_data();
   }
   else {
-    root[ "type" ] = "node";
+    root[ "type" ] = node.is_inherited() ? "inherited" : "node";
     root[ "count" ] = node.get_count();
     const auto camap = node.get_child_availability_map();
     root[ "camap" ] = camap.value;
+    if( node.is_inherited() ) {
+      root[ "value" ] = node.get_data();
+      root[ "inherited" ] = node.get_inherited_children();
+    }
   }
 }
 
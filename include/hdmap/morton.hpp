@@ -0,0 +1,135 @@
+#ifndef HDMAP_MORTON_HPP
+#define HDMAP_MORTON_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <boost/integer.hpp>
+#include <hdmap/hdmap.hpp>
+#if defined( __BMI2__ )
+#include <immintrin.h>
+#endif
+
+namespace hdmap {
+
+namespace detail {
+
+// The Morton code of a key interleaves the components 2 bits per axis per level, so each level is one child index.
+// The digit of depth d is the child index of the node at depth d containing the voxel, at the same bits in the codes of every depth.
+template< std::unsigned_integral T, unsigned int dims >
+constexpr unsigned int get_morton_code_bits() {
+  return get_max_depth< T, dims >() * dims * 2u;
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+constexpr unsigned int get_morton_key_bits() {
+  return get_morton_code_bits< T, dims >() + get_depth_bits< T, dims >();
+}
+
+// The smallest unsigned integer holding the code and the depth. This is wider than T if the components have an odd number of bits.
+template< std::unsigned_integral T, unsigned int dims >
+using morton_key_t = typename boost::uint_t< std::min( get_morton_key_bits< T, dims >(), 64u ) >::least;
+
+// The bits of the code taken by the component i
+template< std::unsigned_integral T, unsigned int dims >
+constexpr std::uint64_t get_morton_axis_mask( unsigned int i ) {
+  std::uint64_t mask = 0u;
+  for( unsigned int level = 0u; level != get_max_depth< T, dims >(); ++level )
+    mask |= std::uint64_t( 0x3u ) << ( ( level * dims + i ) * 2u );
+  return mask;
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+constexpr auto get_morton_code_portable( T key ) {
+  morton_key_t< T, dims > code = 0u;
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    const std::uint64_t component = get_component< T, dims >( i, key );
+    for( unsigned int level = 0u; level != get_max_depth< T, dims >(); ++level )
+      code |= morton_key_t< T, dims >( ( component >> ( level * 2u ) ) & 0x3u ) << ( ( level * dims + i ) * 2u );
+  }
+  return code;
+}
+
+// pdep places the bits of each component to the bits of its mask in one instruction
+template< std::unsigned_integral T, unsigned int dims >
+constexpr auto get_morton_code( T key ) {
+#if defined( __BMI2__ )
+  if( !std::is_constant_evaluated() ) {
+    std::uint64_t code = 0u;
+    for( unsigned int i = 0u; i != dims; ++i )
+      code |= _pdep_u64( std::uint64_t( get_component< T, dims >( i, key ) ), get_morton_axis_mask< T, dims >( i ) );
+    return morton_key_t< T, dims >( code );
+  }
+#endif
+  return get_morton_code_portable< T, dims >( key );
+}
+
+// The key of depth whose first voxel has the code
+template< std::unsigned_integral T, unsigned int dims >
+constexpr T from_morton_code_portable( morton_key_t< T, dims > code, unsigned int depth ) {
+  T key = to_key< T, dims >( depth );
+  for( unsigned int i = 0u; i != dims; ++i ) {
+    std::uint64_t component = 0u;
+    for( unsigned int level = 0u; level != get_max_depth< T, dims >(); ++level )
+      component |= std::uint64_t( ( code >> ( ( level * dims + i ) * 2u ) ) & 0x3u ) << ( level * 2u );
+    set_component< T, dims >( i, key, T( component ) );
+  }
+  return key;
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+constexpr T from_morton_code( morton_key_t< T, dims > code, unsigned int depth ) {
+#if defined( __BMI2__ )
+  if( !std::is_constant_evaluated() ) {
+    T key = to_key< T, dims >( depth );
+    for( unsigned int i = 0u; i != dims; ++i )
+      set_component< T, dims >( i, key, T( _pext_u64( std::uint64_t( code ), get_morton_axis_mask< T, dims >( i ) ) ) );
+    return key;
+  }
+#endif
+  return from_morton_code_portable< T, dims >( code, depth );
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+constexpr auto get_morton_depth_mask() {
+  return ( morton_key_t< T, dims >( 1u ) << get_depth_bits< T, dims >() ) - 1u;
+}
+
+}
+
+// The key in the Morton key format, which is the code followed by the height of the node from the root.
+// Sorting the keys visits the nodes in depth first order with the children in Z-order, as a node has the code of its first voxel and a larger depth than the nodes inside it.
+// The key has to be inside the root key.
+template< std::unsigned_integral T, unsigned int dims >
+constexpr detail::morton_key_t< T, dims > to_morton_key( T key ) {
+  static_assert( detail::get_morton_key_bits< T, dims >() <= 64u, "to_morton_key: The key format is too large for a 64bit Morton key" );
+  using M = detail::morton_key_t< T, dims >;
+  return M(
+    ( detail::get_morton_code< T, dims >( key ) << detail::get_depth_bits< T, dims >() ) |
+    M( detail::get_max_depth< T, dims >() - detail::get_depth< T, dims >( key ) )
+  );
+}
+
+template< std::unsigned_integral T, unsigned int dims >
+constexpr T from_morton_key( detail::morton_key_t< T, dims > key ) {
+  return detail::from_morton_code< T, dims >(
+    key >> detail::get_depth_bits< T, dims >(),
+    detail::get_max_depth< T, dims >() - unsigned( key & detail::get_morton_depth_mask< T, dims >() )
+  );
+}
+
+// The Morton key in the most significant bits, for the containers using those bits first such as persistent_node_map.
+// The trie is then split by the root children first, and a modification of a small region copies less of it.
+// This is not suitable for the hash tables, which use the least significant bits.
+template< std::unsigned_integral T, unsigned int dims >
+struct morton_key_hash {
+  std::size_t operator()( T v ) const {
+    static_assert( detail::get_morton_key_bits< T, dims >() <= sizeof( std::size_t ) * 8u );
+    return std::size_t( to_morton_key< T, dims >( v ) ) << ( sizeof( std::size_t ) * 8u - detail::get_morton_key_bits< T, dims >() );
+  }
+};
+
+}
+#endif
+
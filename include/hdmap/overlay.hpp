@@ -0,0 +1,220 @@
+#ifndef HDMAP_OVERLAY_HPP
+#define HDMAP_OVERLAY_HPP
+
+#include <array>
+#include <optional>
+#include <hdmap/hdmap.hpp>
+
+namespace hdmap {
+
+namespace detail {
+
+enum class overlay_mode_t {
+  UNION,
+  INTERSECTION,
+  DIFFERENCE
+};
+
+// The node of map standing for the child slot child_key of slot_key, given the node standing for slot_key.
+// That is nullptr if the slot is empty, a node covering the slot or a node inside the slot.
+template< HDMapUnderlyingContainer C >
+const extract_node_type_t< C > *get_overlay_child(
+  const C &map,
+  const extract_node_type_t< C > *current_node,
+  extract_key_type_t< C > slot_key,
+  extract_key_type_t< C > child_key
+) {
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( !current_node ) return nullptr;
+  if( covers( *current_node, slot_key ) ) return current_node;
+  if( current_node->get_range() == slot_key ) {
+    if( current_node->has_inherited_child( child_key ) ) return current_node;
+    if( !current_node->has_child( child_key ) ) return nullptr;
+    const auto child_node = map.find( child_key );
+    assert( child_node != map.end() );
+    return &child_node->second;
+  }
+  return contains< T, dims >( child_key, current_node->get_range() ) ? current_node : nullptr;
+}
+
+// Copy the part of the subtree of current_node inside slot_key to out.
+// The descendants are inserted to out and the node for slot_key is returned for the caller to place.
+template< HDMapUnderlyingContainer C >
+extract_node_type_t< C > copy_subtree(
+  const C &map,
+  const extract_node_type_t< C > &current_node,
+  extract_key_type_t< C > slot_key,
+  C &out
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( covers( current_node, slot_key ) ) return extract_node_type_t< C >( slot_key, U( current_node.get_data() ) );
+  if( current_node.is_leaf() ) return extract_node_type_t< C >( current_node.get_range(), U( current_node.get_data() ) );
+  // an inherited node is copied with its inherited value and holes
+  auto copied = current_node.is_inherited() ?
+    current_node :
+    extract_node_type_t< C >( current_node.get_range(), child_availability_map< T, dims >() );
+  for_each_child(
+    map,
+    current_node,
+    [&]( const auto &child_node, auto ) {
+      out.insert( std::make_pair( child_node->first, copy_subtree( map, child_node->second, child_node->first, out ) ) );
+      copied.set_child( child_node->first );
+      return true;
+    }
+  );
+  return copied;
+}
+
+// Make the node for slot_key from the combined children, inserting the children that are kept to out.
+// Uniform children are merged by func and a single child is moved up, which leaves out in the same shape as after coalesce.
+template< HDMapUnderlyingContainer C, typename E >
+std::optional< extract_node_type_t< C > > place_children(
+  std::array< std::optional< extract_node_type_t< C > >, get_max_child_count< extract_dims_v< C > >() > &children,
+  extract_key_type_t< C > slot_key,
+  C &out,
+  const E &func
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  const auto first_child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( slot_key ) - 1u, slot_key );
+  unsigned int child_count = 0u;
+  unsigned int last_child_index = 0u;
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    if( children[ i ] ) {
+      ++child_count;
+      last_child_index = i;
+    }
+  }
+  if( child_count == 0u ) return std::nullopt;
+  if( child_count == 1u ) return std::move( children[ last_child_index ] );
+  if( child_count == get_max_child_count< dims >() ) {
+    bool uniform = true;
+    for( unsigned int i = 0u; i != get_max_child_count< dims >() && uniform; ++i ) {
+      uniform =
+        children[ i ]->is_leaf() &&
+        children[ i ]->get_range() == child_index_to_key< T, dims >( first_child_key, i ) &&
+        func( children[ i ]->get_data(), children[ 0 ]->get_data() );
+    }
+    if( uniform ) return N( slot_key, U( children[ 0 ]->get_data() ) );
+  }
+  N combined( slot_key, child_availability_map< T, dims >() );
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    if( !children[ i ] ) continue;
+    const auto child_key = child_index_to_key< T, dims >( first_child_key, i );
+    out.insert( std::make_pair( child_key, std::move( *children[ i ] ) ) );
+    combined.set_child( child_key );
+  }
+  return combined;
+}
+
+// Combine the nodes of a and b standing for slot_key into out, returning the node for slot_key or nullopt if the slot is empty.
+// A side that is empty is copied or skipped as a whole, and so is a leaf containing the slot on both sides.
+// The children are combined first and placed by place_children.
+template< HDMapUnderlyingContainer C, typename F, typename E >
+std::optional< extract_node_type_t< C > > overlay(
+  const C &a,
+  const extract_node_type_t< C > *a_node,
+  const C &b,
+  const extract_node_type_t< C > *b_node,
+  extract_key_type_t< C > slot_key,
+  C &out,
+  overlay_mode_t mode,
+  const F &merge,
+  const E &func
+) {
+  using T = extract_key_type_t< C >;
+  using U = extract_value_type_t< C >;
+  using N = extract_node_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  if( !a_node && !b_node ) return std::nullopt;
+  if( !b_node ) {
+    if( mode == overlay_mode_t::INTERSECTION ) return std::nullopt;
+    return copy_subtree( a, *a_node, slot_key, out );
+  }
+  if( !a_node ) {
+    if( mode != overlay_mode_t::UNION ) return std::nullopt;
+    return copy_subtree( b, *b_node, slot_key, out );
+  }
+  const bool a_covers = covers( *a_node, slot_key );
+  const bool b_covers = covers( *b_node, slot_key );
+  if( b_covers && mode == overlay_mode_t::DIFFERENCE ) return std::nullopt;
+  if( a_covers && b_covers ) return N( slot_key, U( merge( a_node->get_data(), b_node->get_data() ) ) );
+  std::array< std::optional< N >, get_max_child_count< dims >() > children;
+  const auto first_child_key = get_key_in_depth< T, dims >( get_depth< T, dims >( slot_key ) - 1u, slot_key );
+  for( unsigned int i = 0u; i != get_max_child_count< dims >(); ++i ) {
+    const auto child_key = child_index_to_key< T, dims >( first_child_key, i );
+    children[ i ] = overlay(
+      a,
+      get_overlay_child( a, a_node, slot_key, child_key ),
+      b,
+      get_overlay_child( b, b_node, slot_key, child_key ),
+      child_key,
+      out,
+      mode,
+      merge,
+      func
+    );
+  }
+  return place_children( children, slot_key, out, func );
+}
+
+template< HDMap M, typename F >
+M overlay( const M &a, const M &b, overlay_mode_t mode, const F &merge ) {
+  using C = std::remove_cvref_t< decltype( a.nodes() ) >;
+  using T = extract_key_type_t< C >;
+  constexpr auto dims = extract_dims_v< C >;
+  constexpr auto root_key = get_root_key< T, dims >();
+  const auto a_root = a.nodes().find( root_key );
+  const auto b_root = b.nodes().find( root_key );
+  C out;
+  // growing the table while the result is built costs as much as the traversal
+  if constexpr ( requires { out.reserve( std::size_t( 0u ) ); } )
+    out.reserve( a.nodes().size() + ( mode == overlay_mode_t::UNION ? b.nodes().size() : 0u ) );
+  auto root_node = overlay(
+    a.nodes(),
+    a_root != a.nodes().end() ? &a_root->second : nullptr,
+    b.nodes(),
+    b_root != b.nodes().end() ? &b_root->second : nullptr,
+    root_key,
+    out,
+    mode,
+    merge,
+    a.value_eq()
+  );
+  if( root_node ) out.insert( std::make_pair( root_key, std::move( *root_node ) ) );
+  return M( a.value_eq(), std::move( out ) );
+}
+
+}
+
+// The voxels of a and b. A voxel present in both maps holds merge( value in a, value in b ).
+template< HDMap M, typename F >
+M overlay( const M &a, const M &b, F &&merge ) {
+  return detail::overlay( a, b, detail::overlay_mode_t::UNION, merge );
+}
+
+// The voxels present in both maps, holding merge( value in a, value in b )
+template< HDMap M, typename F >
+M intersect( const M &a, const M &b, F &&merge ) {
+  return detail::overlay( a, b, detail::overlay_mode_t::INTERSECTION, merge );
+}
+
+// The voxels of a that are empty in b
+template< HDMap M >
+M subtract( const M &a, const M &b ) {
+  return detail::overlay(
+    a,
+    b,
+    detail::overlay_mode_t::DIFFERENCE,
+    []( const auto &l, const auto& ) { return l; }
+  );
+}
+
+}
+#endif
+
@@ -0,0 +1,381 @@
+#ifndef HDMAP_PERSISTENT_CONTAINER_HPP
+#define HDMAP_PERSISTENT_CONTAINER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <bit>
+#include <array>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+
+namespace hdmap {
+
+// A node map sharing its structure between copies.
+// The elements are kept in a trie on the hash of the key, 4 bits per level, so copying the map only copies the root pointer.
+// A modification copies the trie nodes from the root to the element, and the element itself, if they are shared with a copy.
+// Hash has to map distinct keys to distinct values, which key_hash does.
+// A copy can be read from another thread while the original is modified, but copying has to be done by the thread modifying the original.
+// The elements are never moved, so references stay valid until the element is erased or the map is copied.
+// The elements are iterated in the order of their hash.
+// The iterators of a non-const map copy each element they reach and its path if they are shared, so writing through them doesn't change a copy.
+template<
+  std::unsigned_integral K,
+  typename V,
+  typename Hash = key_hash< K, 1u >,
+  typename Pred = std::equal_to< K >
+>
+class persistent_node_map {
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair< const K, V >;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = Pred;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+private:
+  constexpr static unsigned int level_bits = 4u;
+  constexpr static unsigned int max_level = sizeof( std::size_t ) * 8u / level_bits;
+  struct trie_node {
+    std::uint16_t element_map = 0u;
+    std::uint16_t child_map = 0u;
+    std::vector< std::shared_ptr< value_type > > elements;
+    std::vector< std::shared_ptr< trie_node > > children;
+  };
+  template< bool is_const >
+  class iterator_base {
+    using map_type = std::conditional_t< is_const, const persistent_node_map, persistent_node_map >;
+  public:
+    using value_type = typename persistent_node_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t< is_const, const value_type&, value_type& >;
+    using pointer = std::conditional_t< is_const, const value_type*, value_type* >;
+    using iterator_category = std::forward_iterator_tag;
+    iterator_base() = default;
+    iterator_base( map_type *map_, value_type *element_ ) : map( map_ ), element( element_ ) {}
+    template< bool r_is_const, typename = std::enable_if_t< is_const && !r_is_const > >
+    iterator_base( const iterator_base< r_is_const > &r ) : map( r.map ), element( r.element ) {}
+    reference operator*() const {
+      return *element;
+    }
+    pointer operator->() const {
+      return element;
+    }
+    iterator_base &operator++() {
+      if constexpr ( is_const ) element = map->next( element->first );
+      else element = map->next_unique( element->first );
+      return *this;
+    }
+    iterator_base operator++( int ) {
+      auto temp = *this;
+      ++*this;
+      return temp;
+    }
+    template< bool r_is_const >
+    bool operator==( const iterator_base< r_is_const > &r ) const {
+      return element == r.element;
+    }
+  private:
+    template< bool >
+    friend class iterator_base;
+    friend class persistent_node_map;
+    map_type *map = nullptr;
+    value_type *element = nullptr;
+  };
+public:
+  using iterator = iterator_base< false >;
+  using const_iterator = iterator_base< true >;
+  persistent_node_map(
+    const Hash &hash_ = Hash(),
+    const Pred &pred_ = Pred()
+  ) : hash( hash_ ), pred( pred_ ) {}
+  persistent_node_map( const persistent_node_map& ) = default;
+  persistent_node_map( persistent_node_map &&r ) noexcept :
+    hash( std::move( r.hash ) ), pred( std::move( r.pred ) ),
+    root( std::move( r.root ) ), used( std::exchange( r.used, 0u ) ) {}
+  persistent_node_map &operator=( const persistent_node_map& ) = default;
+  persistent_node_map &operator=( persistent_node_map &&r ) noexcept {
+    hash = std::move( r.hash );
+    pred = std::move( r.pred );
+    root = std::move( r.root );
+    used = std::exchange( r.used, 0u );
+    return *this;
+  }
+  void swap( persistent_node_map &r ) noexcept {
+    std::swap( hash, r.hash );
+    std::swap( pred, r.pred );
+    root.swap( r.root );
+    std::swap( used, r.used );
+  }
+  iterator begin() {
+    const auto first = lower_bound( 0u );
+    return iterator( this, first ? find( first->first ).element : nullptr );
+  }
+  const_iterator begin() const {
+    return const_iterator( this, lower_bound( 0u ) );
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  iterator end() {
+    return iterator( this, nullptr );
+  }
+  const_iterator end() const {
+    return const_iterator( this, nullptr );
+  }
+  const_iterator cend() const {
+    return end();
+  }
+  bool empty() const {
+    return used == 0u;
+  }
+  size_type size() const {
+    return used;
+  }
+  void clear() {
+    root.reset();
+    used = 0u;
+  }
+  // The element is copied first if it is shared, so that it can be modified through the iterator.
+  // A key which is not there copies nothing, as the path is looked up without copying first.
+  iterator find( const K &key ) {
+    const auto [element,shared] = find_shared( key );
+    if( !element ) return end();
+    if( !shared ) {
+      std::atomic_thread_fence( std::memory_order_acquire );
+      return iterator( this, element );
+    }
+    return iterator( this, make_path_unique( key ) );
+  }
+  const_iterator find( const K &key ) const {
+    const auto h = hash( key );
+    const trie_node *current = root.get();
+    for( unsigned int level = 0u; current; ++level ) {
+      const auto bit = get_bit( h, level );
+      if( current->element_map & bit ) {
+        const auto &element = current->elements[ get_rank( current->element_map, bit ) ];
+        return pred( element->first, key ) ? const_iterator( this, element.get() ) : end();
+      }
+      if( !( current->child_map & bit ) ) return end();
+      current = current->children[ get_rank( current->child_map, bit ) ].get();
+    }
+    return end();
+  }
+  size_type count( const K &key ) const {
+    return find( key ) != end();
+  }
+  bool contains( const K &key ) const {
+    return find( key ) != end();
+  }
+  template< typename P >
+  std::pair< iterator, bool > insert( P &&v ) {
+    return emplace( std::forward< P >( v ).first, std::forward< P >( v ).second );
+  }
+  template< typename M >
+  std::pair< iterator, bool > emplace( const K &key, M &&mapped ) {
+    const auto h = hash( key );
+    if( !root ) root = std::make_shared< trie_node >();
+    std::shared_ptr< trie_node > *link = &root;
+    for( unsigned int level = 0u; level != max_level; ++level ) {
+      const auto current = make_unique( *link );
+      const auto bit = get_bit( h, level );
+      if( current->element_map & bit ) {
+        const auto rank = get_rank( current->element_map, bit );
+        auto &element = current->elements[ rank ];
+        if( pred( element->first, key ) ) return std::make_pair( iterator( this, make_unique( element ) ), false );
+        // push the element down to a new child, which the next level inserts the key to
+        assert( level + 1u != max_level && "Hash is not injective" );
+        auto child = std::make_shared< trie_node >();
+        child->element_map = get_bit( hash( element->first ), level + 1u );
+        child->elements.push_back( std::move( element ) );
+        current->elements.erase( std::next( current->elements.begin(), rank ) );
+        current->element_map &= ~bit;
+        current->child_map |= bit;
+        link = &*current->children.insert( std::next( current->children.begin(), get_rank( current->child_map, bit ) ), std::move( child ) );
+        continue;
+      }
+      if( current->child_map & bit ) {
+        link = &current->children[ get_rank( current->child_map, bit ) ];
+        continue;
+      }
+      current->element_map |= bit;
+      const auto inserted = current->elements.insert(
+        std::next( current->elements.begin(), get_rank( current->element_map, bit ) ),
+        std::make_shared< value_type >( key, std::forward< M >( mapped ) )
+      );
+      ++used;
+      return std::make_pair( iterator( this, inserted->get() ), true );
+    }
+    assert( false && "Hash is not injective" );
+    return std::make_pair( end(), false );
+  }
+  size_type erase( const K &key ) {
+    if( !find_shared( key ).first ) return 0u;
+    const auto h = hash( key );
+    std::array< trie_node*, max_level > path;
+    std::shared_ptr< trie_node > *link = &root;
+    for( unsigned int level = 0u; *link; ++level ) {
+      const auto current = make_unique( *link );
+      path[ level ] = current;
+      const auto bit = get_bit( h, level );
+      if( current->element_map & bit ) {
+        const auto rank = get_rank( current->element_map, bit );
+        if( !pred( current->elements[ rank ]->first, key ) ) return 0u;
+        current->elements.erase( std::next( current->elements.begin(), rank ) );
+        current->element_map &= ~bit;
+        --used;
+        shrink( path, level, h );
+        return 1u;
+      }
+      if( !( current->child_map & bit ) ) return 0u;
+      link = &current->children[ get_rank( current->child_map, bit ) ];
+    }
+    return 0u;
+  }
+  iterator erase( const_iterator pos ) {
+    const K key = pos->first;
+    erase( key );
+    return iterator( this, next_unique( key ) );
+  }
+  iterator erase( iterator pos ) {
+    return erase( const_iterator( pos ) );
+  }
+  hasher hash_function() const {
+    return hash;
+  }
+  key_equal key_eq() const {
+    return pred;
+  }
+private:
+  static std::uint16_t get_bit( std::size_t h, unsigned int level ) {
+    return std::uint16_t( 1u << ( ( h >> ( ( max_level - 1u - level ) * level_bits ) ) & 0xFu ) );
+  }
+  static unsigned int get_rank( std::uint16_t map, std::uint16_t bit ) {
+    return std::popcount( std::uint16_t( map & ( bit - 1u ) ) );
+  }
+  // Replace a shared pointee by a copy owned by this map only.
+  // Only the thread modifying this map can add owners, so a count of 1 can't grow under us, and the
+  // fence orders our writes after the reads of a copy that dropped its reference on another thread.
+  template< typename T >
+  static T *make_unique( std::shared_ptr< T > &p ) {
+    if( p.use_count() != 1 ) p = std::make_shared< T >( *p );
+    else std::atomic_thread_fence( std::memory_order_acquire );
+    return p.get();
+  }
+  // The element of key, or nullptr if the key is not there, and whether the element or a trie node on its path is shared with a copy
+  std::pair< value_type*, bool > find_shared( const K &key ) const {
+    const auto h = hash( key );
+    bool shared = false;
+    const std::shared_ptr< trie_node > *link = &root;
+    for( unsigned int level = 0u; *link; ++level ) {
+      shared = shared || link->use_count() != 1;
+      const auto &current = **link;
+      const auto bit = get_bit( h, level );
+      if( current.element_map & bit ) {
+        const auto &element = current.elements[ get_rank( current.element_map, bit ) ];
+        if( !pred( element->first, key ) ) return std::make_pair( nullptr, false );
+        return std::make_pair( element.get(), shared || element.use_count() != 1 );
+      }
+      if( !( current.child_map & bit ) ) return std::make_pair( nullptr, false );
+      link = &current.children[ get_rank( current.child_map, bit ) ];
+    }
+    return std::make_pair( nullptr, false );
+  }
+  // Copy the path to the element of key and the element if they are shared. The key has to be in the map.
+  value_type *make_path_unique( const K &key ) {
+    const auto h = hash( key );
+    std::shared_ptr< trie_node > *link = &root;
+    for( unsigned int level = 0u; ; ++level ) {
+      const auto current = make_unique( *link );
+      const auto bit = get_bit( h, level );
+      if( current->element_map & bit ) {
+        auto &element = current->elements[ get_rank( current->element_map, bit ) ];
+        assert( pred( element->first, key ) );
+        return make_unique( element );
+      }
+      assert( current->child_map & bit );
+      link = &current->children[ get_rank( current->child_map, bit ) ];
+    }
+  }
+  // Drop the trie nodes left empty by an erase and pull a lone element up, so that the trie stays as shallow as the hashes allow
+  void shrink( std::array< trie_node*, max_level > &path, unsigned int level, std::size_t h ) {
+    for( ; level != 0u; --level ) {
+      const auto current = path[ level ];
+      const auto parent = path[ level - 1u ];
+      const auto bit = get_bit( h, level - 1u );
+      const auto rank = get_rank( parent->child_map, bit );
+      if( current->children.empty() && current->elements.size() <= 1u ) {
+        if( current->elements.size() == 1u ) {
+          parent->element_map |= bit;
+          parent->elements.insert( std::next( parent->elements.begin(), get_rank( parent->element_map, bit ) ), std::move( current->elements.front() ) );
+        }
+        parent->children.erase( std::next( parent->children.begin(), rank ) );
+        parent->child_map &= ~bit;
+      }
+      else return;
+    }
+    if( !root->element_map && !root->child_map ) root.reset();
+  }
+  // The element with the smallest hash not less than h
+  value_type *lower_bound( std::size_t h ) const {
+    return root ? lower_bound( *root, h, 0u, true ) : nullptr;
+  }
+  value_type *lower_bound( const trie_node &current, std::size_t h, unsigned int level, bool bounded ) const {
+    const unsigned int first = bounded ? ( ( h >> ( ( max_level - 1u - level ) * level_bits ) ) & 0xFu ) : 0u;
+    for( unsigned int i = first; i != 16u; ++i ) {
+      const auto bit = std::uint16_t( 1u << i );
+      const bool on_bound = bounded && i == first;
+      if( current.element_map & bit ) {
+        const auto &element = current.elements[ get_rank( current.element_map, bit ) ];
+        if( !on_bound || hash( element->first ) >= h ) return element.get();
+      }
+      else if( current.child_map & bit ) {
+        const auto found = lower_bound( *current.children[ get_rank( current.child_map, bit ) ], h, level + 1u, on_bound );
+        if( found ) return found;
+      }
+    }
+    return nullptr;
+  }
+  value_type *next( const K &key ) const {
+    const auto h = hash( key );
+    return h == std::numeric_limits< std::size_t >::max() ? nullptr : lower_bound( h + 1u );
+  }
+  // The next element, copied with its path if it is shared
+  value_type *next_unique( const K &key ) {
+    const auto found = next( key );
+    return found ? find( found->first ).element : nullptr;
+  }
+  Hash hash;
+  Pred pred;
+  std::shared_ptr< trie_node > root;
+  size_type used = 0u;
+};
+
+template<
+  std::unsigned_integral T,
+  typename U,
+  unsigned int dims,
+  typename Hash = key_hash< T, dims >,
+  typename Pred = std::equal_to< T >
+>
+using persistent_underlying_container_t = persistent_node_map<
+  T,
+  detail::node< T, U, dims >,
+  Hash,
+  Pred
+>;
+
+}
+#endif
+
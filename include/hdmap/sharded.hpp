@@ -0,0 +1,277 @@
+#ifndef HDMAP_SHARDED_HPP
+#define HDMAP_SHARDED_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <array>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include <hdmap/hdmap.hpp>
+
+namespace hdmap {
+
+// A map split into one hdmap for each child slot of the root key, each with its own lock.
+// The modifications of disjoint shards can run on different threads at the same time.
+// A range spanning several shards is split along the shard boundaries, and each shard is locked while its part is processed, so a modification spanning shards is not atomic.
+// The rectangles found in several shards are not merged across the shard boundaries.
+template<
+  std::unsigned_integral T,
+  typename U,
+  unsigned int dims,
+  std::regular_invocable< const U&, const U& > EqualTo = std::equal_to< U >,
+  HDMapUnderlyingContainer C = standard_underlying_container_t< T, U, dims >
+>
+class sharded_hdmap {
+public:
+  using map_type = hdmap< T, U, dims, EqualTo, C >;
+  using rect_type = typename map_type::rect_type;
+  using key_type = typename map_type::key_type;
+  using mapped_type = typename map_type::mapped_type;
+  using value_type = typename map_type::value_type;
+  static constexpr unsigned int shard_count = detail::get_max_child_count< dims >();
+  sharded_hdmap(
+    const EqualTo &equal_to = EqualTo{}
+  ) {
+    const auto root_key = detail::get_root_key< T, dims >();
+    const auto first_child_key = detail::get_key_in_depth< T, dims >( detail::get_depth< T, dims >( root_key ) - 1u, root_key );
+    for( unsigned int i = 0u; i != shard_count; ++i ) {
+      shards[ i ].map = map_type( EqualTo( equal_to ) );
+      shards[ i ].range = detail::to_rectangle< key_type, dims >( detail::child_index_to_key< T, dims >( first_child_key, i ) );
+    }
+  }
+  sharded_hdmap( const sharded_hdmap& ) = delete;
+  sharded_hdmap &operator=( const sharded_hdmap& ) = delete;
+  template< std::unsigned_integral ...I >
+  static key_type enc( I ...v ) {
+    return map_type::enc( v... );
+  }
+  static rect_type rect( key_type begin, key_type end ) {
+    return map_type::rect( begin, end );
+  }
+  // The shard containing the voxel
+  static unsigned int get_shard_index( key_type point ) {
+    unsigned int index = 0u;
+    for( unsigned int i = 0u; i != dims; ++i )
+      index |= ( ( detail::get_component< key_type, dims >( i, point ) >> ( ( detail::get_depth< T, dims >( detail::get_root_key< T, dims >() ) - 1u ) * 2u ) ) & 0x3u ) << ( i * 2u );
+    return index;
+  }
+  const rect_type &get_shard_range( unsigned int index ) const {
+    return shards[ index ].range;
+  }
+  bool update(
+    const rect_type &range,
+    U &&value
+  ) {
+    bool updated = false;
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool last ) {
+        std::unique_lock< std::shared_mutex > lock( shard.mutex );
+        updated |= bool( shard.map.update( clipped, last ? std::move( value ) : U( value ) ) );
+      }
+    );
+    return updated;
+  }
+  std::size_t erase(
+    const rect_type &range
+  ) {
+    std::size_t erased = 0u;
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        std::unique_lock< std::shared_mutex > lock( shard.mutex );
+        erased += shard.map.erase( clipped );
+      }
+    );
+    return erased;
+  }
+  // Same result as calling update for each element in order.
+  // The updates are grouped by shard, and each shard is locked once.
+  void update_batch(
+    std::span< const value_type > updates
+  ) {
+    std::array< std::vector< value_type >, shard_count > split;
+    for( const auto &v: updates ) {
+      for_each_shard(
+        *this,
+        v.first,
+        [&]( auto &shard, const auto &clipped, bool ) {
+          split[ std::distance( shards.data(), &shard ) ].emplace_back( clipped, v.second );
+        }
+      );
+    }
+    for( unsigned int i = 0u; i != shard_count; ++i ) {
+      if( split[ i ].empty() ) continue;
+      std::unique_lock< std::shared_mutex > lock( shards[ i ].mutex );
+      shards[ i ].map.update_batch( std::span< const value_type >( split[ i ] ) );
+    }
+  }
+  // The results of each shard are appended in shard order
+  void find(
+    const rect_type &range,
+    std::vector< value_type > &dest,
+    decomposition_mode_t mode = decomposition_mode_t::FEWEST
+  ) const {
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        std::shared_lock< std::shared_mutex > lock( shard.mutex );
+        shard.map.find( clipped, dest, mode );
+      }
+    );
+  }
+  // cb is called with the lock of the shard held, so it must not modify the map
+  template< std::invocable< const rect_type&, const U& > F >
+  void find(
+    const rect_type &range,
+    F &&cb,
+    decomposition_mode_t mode = decomposition_mode_t::FEWEST
+  ) const {
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        std::shared_lock< std::shared_mutex > lock( shard.mutex );
+        shard.map.find( clipped, cb, mode );
+      }
+    );
+  }
+  // dest[ i ] is the value of the voxel points[ i ], or nullopt if the voxel is empty.
+  // The values are copied, since a pointer would be invalidated by a modification on another thread.
+  void find_points(
+    std::span< const key_type > points,
+    std::span< std::optional< U > > dest
+  ) const {
+    assert( dest.size() >= points.size() );
+    std::array< std::vector< std::size_t >, shard_count > indices;
+    for( std::size_t i = 0u; i != points.size(); ++i ) {
+      dest[ i ] = std::nullopt;
+      indices[ get_shard_index( points[ i ] ) ].push_back( i );
+    }
+    std::vector< key_type > keys;
+    std::vector< const U* > found;
+    for( unsigned int i = 0u; i != shard_count; ++i ) {
+      if( indices[ i ].empty() ) continue;
+      keys.clear();
+      for( const auto index: indices[ i ] ) keys.push_back( points[ index ] );
+      found.resize( keys.size() );
+      std::shared_lock< std::shared_mutex > lock( shards[ i ].mutex );
+      shards[ i ].map.find_points( std::span< const key_type >( keys ), std::span< const U* >( found ) );
+      for( std::size_t j = 0u; j != keys.size(); ++j ) {
+        if( found[ j ] ) dest[ indices[ i ][ j ] ] = *found[ j ];
+      }
+    }
+  }
+  // The number of non empty voxels in range, without allocating
+  std::size_t count(
+    const rect_type &range
+  ) const {
+    std::size_t sum = 0u;
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        std::shared_lock< std::shared_mutex > lock( shard.mutex );
+        sum += shard.map.count( clipped );
+      }
+    );
+    return sum;
+  }
+  // The number of voxels in range holding a value satisfying pred, without allocating
+  template< std::predicate< const U& > F >
+  std::size_t count_if(
+    const rect_type &range,
+    F &&pred
+  ) const {
+    std::size_t sum = 0u;
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        std::shared_lock< std::shared_mutex > lock( shard.mutex );
+        sum += shard.map.count_if( clipped, pred );
+      }
+    );
+    return sum;
+  }
+  // Whether range contains a non empty voxel, without allocating
+  bool any(
+    const rect_type &range
+  ) const {
+    bool found = false;
+    for_each_shard(
+      *this,
+      range,
+      [&]( auto &shard, const auto &clipped, bool ) {
+        if( found ) return;
+        std::shared_lock< std::shared_mutex > lock( shard.mutex );
+        found = shard.map.any( clipped );
+      }
+    );
+    return found;
+  }
+  // The number of non empty voxels
+  std::size_t size() const {
+    std::size_t sum = 0u;
+    for( const auto &shard: shards ) {
+      std::shared_lock< std::shared_mutex > lock( shard.mutex );
+      sum += shard.map.size();
+    }
+    return sum;
+  }
+  bool empty() const {
+    for( const auto &shard: shards ) {
+      std::shared_lock< std::shared_mutex > lock( shard.mutex );
+      if( !shard.map.empty() ) return false;
+    }
+    return true;
+  }
+  void clear() {
+    for( auto &shard: shards ) {
+      std::unique_lock< std::shared_mutex > lock( shard.mutex );
+      shard.map.clear();
+    }
+  }
+  // Call f with the map of the shard index while the shard is locked for writing
+  template< std::invocable< map_type& > F >
+  decltype( auto ) with_shard( unsigned int index, F &&f ) {
+    std::unique_lock< std::shared_mutex > lock( shards[ index ].mutex );
+    return std::forward< F >( f )( shards[ index ].map );
+  }
+  template< std::invocable< const map_type& > F >
+  decltype( auto ) with_shard( unsigned int index, F &&f ) const {
+    std::shared_lock< std::shared_mutex > lock( shards[ index ].mutex );
+    return std::forward< F >( f )( shards[ index ].map );
+  }
+private:
+  // the shards are written by different threads, so each is kept on its own cache line
+  struct alignas( 64 ) shard_type {
+    map_type map;
+    rect_type range;
+    mutable std::shared_mutex mutex;
+  };
+  // Call func( shard, the part of range in the shard, whether this is the last shard ) for each shard overlapping range
+  template< typename Self, typename F >
+  static void for_each_shard( Self &self, const rect_type &range, F &&func ) {
+    std::array< unsigned int, shard_count > overlapping;
+    unsigned int overlapping_count = 0u;
+    for( unsigned int i = 0u; i != shard_count; ++i ) {
+      if( detail::get_overlap_count( self.shards[ i ].range, range ) != 0u ) overlapping[ overlapping_count++ ] = i;
+    }
+    for( unsigned int i = 0u; i != overlapping_count; ++i )
+      func( self.shards[ overlapping[ i ] ], detail::operator&( self.shards[ overlapping[ i ] ].range, range ), i + 1u == overlapping_count );
+  }
+  std::array< shard_type, shard_count > shards;
+};
+
+}
+#endif
+
@@ -0,0 +1,135 @@
+#ifndef HDMAP_SPARSE_VOXEL_TREE_HPP
+#define HDMAP_SPARSE_VOXEL_TREE_HPP
+
+#include <cstdint>
+#include <cassert>
+#include <bit>
+#include <vector>
+#include <hdmap/hdmap.hpp>
+
+namespace hdmap {
+
+template< std::unsigned_integral T, typename U, unsigned int dims >
+class sparse_voxel_tree {
+  static_assert( detail::camap_traits< dims >::mode == detail::camode_t::FULL, "sparse_voxel_tree requires a full child availability map" );
+  using camap_type = typename detail::camap_traits< dims >::type;
+  // camap == 0 marks a leaf and index refers to values
+  // otherwise the children are stored in nodes[ index ... index + popcount( camap ) )
+  struct packed_node {
+    T range;
+    camap_type camap;
+    std::uint32_t index;
+  };
+public:
+  using rect_type = detail::larger_rectangle_t< rectangle< T, dims > >;
+  using key_type = detail::extract_key_type_t< rect_type >;
+  using mapped_type = U;
+  sparse_voxel_tree() = default;
+  template< HDMapUnderlyingContainer C >
+  explicit sparse_voxel_tree( const C &map ) {
+    static_assert( std::is_same_v< detail::extract_node_type_t< C >, detail::node< T, U, dims > > );
+    const auto root_node = map.find( detail::get_root_key< T, dims >() );
+    if( root_node == map.end() ) return;
+    std::vector< typename C::const_iterator > source;
+    source.push_back( root_node );
+    nodes.push_back( packed_node{ root_node->second.get_range(), 0u, 0u } );
+    for( std::size_t i = 0u; i != source.size(); ++i ) {
+      const auto &current_node = source[ i ]->second;
+      // a child of an inherited node holding the inherited value refers to the parent with the range of the child
+      if( current_node.is_leaf() || nodes[ i ].range != current_node.get_range() ) {
+        nodes[ i ].index = values.size();
+        values.push_back( current_node.get_data() );
+      }
+      else if( current_node.is_inherited() ) {
+        nodes[ i ].index = nodes.size();
+        const auto lower_key = detail::get_key_in_depth< T, dims >( detail::get_depth< T, dims >( current_node.get_range() ) - 1u, current_node.get_range() );
+        for( unsigned int child_index = 0u; child_index != detail::get_max_child_count< dims >(); ++child_index ) {
+          const auto child_key = detail::child_index_to_key< T, dims >( lower_key, child_index );
+          auto child_node = source[ i ];
+          auto child_range = child_key;
+          if( !current_node.has_inherited_child( child_key ) ) {
+            if( !current_node.has_child( child_key ) ) continue;
+            child_node = map.find( child_key );
+            assert( child_node != map.end() );
+            child_range = child_node->second.get_range();
+          }
+          nodes[ i ].camap |= camap_type( 1u ) << child_index;
+          source.push_back( child_node );
+          nodes.push_back( packed_node{ child_range, 0u, 0u } );
+        }
+      }
+      else {
+        nodes[ i ].index = nodes.size();
+        detail::for_each_child(
+          map,
+          current_node,
+          [&]( const auto &child_node, auto child_index ) {
+            nodes[ i ].camap |= camap_type( 1u ) << child_index;
+            source.push_back( child_node );
+            nodes.push_back( packed_node{ child_node->second.get_range(), 0u, 0u } );
+            return true;
+          }
+        );
+      }
+    }
+  }
+  template< HDMap M >
+  explicit sparse_voxel_tree( const M &map ) : sparse_voxel_tree( map.nodes() ) {}
+  const U *find( key_type point ) const {
+    if( nodes.empty() ) return nullptr;
+    for( unsigned int i = 0u; i != dims; ++i ) {
+      if( detail::get_component< key_type, dims >( i, point ) > key_type( detail::get_component_max< T, dims >() ) ) return nullptr;
+    }
+    const auto key = key_cast< T, dims >( detail::get_key_in_depth< key_type, dims >( 0u, point ) );
+    const packed_node *current_node = &nodes.front();
+    while( true ) {
+      if( !detail::contains< T, dims >( current_node->range, key ) ) return nullptr;
+      if( !current_node->camap ) return &values[ current_node->index ];
+      const auto child_key = detail::get_key_in_depth< T, dims >( detail::get_depth< T, dims >( current_node->range ) - 1u, key );
+      const auto bit = camap_type( 1u ) << detail::key_to_child_index< T, dims >( child_key );
+      if( !( current_node->camap & bit ) ) return nullptr;
+      current_node = &nodes[ current_node->index + std::popcount( camap_type( current_node->camap & ( bit - 1u ) ) ) ];
+    }
+  }
+  template< typename F >
+  void for_each_leaf( const rect_type &range, F &&func ) const {
+    if( nodes.empty() ) return;
+    for_each_leaf( nodes.front(), range, func );
+  }
+  bool empty() const {
+    return nodes.empty();
+  }
+  std::size_t node_count() const {
+    return nodes.size();
+  }
+  std::size_t leaf_count() const {
+    return values.size();
+  }
+private:
+  template< typename F >
+  void for_each_leaf( const packed_node &current_node, const rect_type &range, F &func ) const {
+    using L = detail::extract_key_type_t< rect_type >;
+    const auto node_rect = detail::to_rectangle< L, dims >( current_node.range );
+    if( detail::get_overlap_count( node_rect, range ) == 0u ) return;
+    if( !current_node.camap ) {
+      func( detail::operator&( node_rect, range ), values[ current_node.index ] );
+      return;
+    }
+    const auto child_count = std::popcount( current_node.camap );
+    for( int i = 0; i != child_count; ++i ) {
+      for_each_leaf( nodes[ current_node.index + i ], range, func );
+    }
+  }
+  std::vector< packed_node > nodes;
+  std::vector< U > values;
+};
+
+template< HDMap M >
+auto make_sparse_voxel_tree( const M &map ) {
+  using C = std::remove_cvref_t< decltype( map.nodes() ) >;
+  return sparse_voxel_tree< detail::extract_key_type_t< C >, detail::extract_value_type_t< C >, detail::extract_dims_v< C > >( map.nodes() );
+}
+
+}
+#endif
+
@@ -0,0 +1,98 @@
+#define BOOST_TEST_MODULE build_from_dense
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/dense.hpp>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+using map3_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+
+// A raster of blobs, so that it has both uniform blocks and noisy edges
+std::vector< unsigned int > make_raster( std::size_t width, std::size_t height, std::mt19937 &rng ) {
+  std::vector< unsigned int > raster( width * height, 0u );
+  std::uniform_int_distribution< std::size_t > position( 0u, std::max( width, height ) );
+  std::uniform_int_distribution< std::size_t > size( 1u, 40u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  for( unsigned int i = 0u; i != 60u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto w = size( rng );
+    const auto h = size( rng );
+    const auto v = value( rng );
+    for( std::size_t j = y; j < std::min( y + h, height ); ++j )
+      for( std::size_t k = x; k < std::min( x + w, width ); ++k )
+        raster[ j * width + k ] = v;
+  }
+  return raster;
+}
+
+// The map made by updating each run of equal voxels of a row
+map_t build_by_update( const std::vector< unsigned int > &raster, std::size_t width, std::size_t height, std::optional< unsigned int > empty ) {
+  map_t map;
+  for( std::size_t y = 0u; y != height; ++y ) {
+    for( std::size_t x = 0u; x != width; ) {
+      auto end = x;
+      while( end != width && raster[ y * width + end ] == raster[ y * width + x ] ) ++end;
+      if( !empty || raster[ y * width + x ] != *empty )
+        map.update( map_t::rect( map_t::enc( x, y ), map_t::enc( end, y + 1u ) ), unsigned( raster[ y * width + x ] ) );
+      x = end;
+    }
+  }
+  return map;
+}
+
+void check_same( const map_t &built, const map_t &expected ) {
+  BOOST_CHECK_EQUAL( built.nodes().size(), expected.nodes().size() );
+  BOOST_CHECK_EQUAL( built.size(), expected.size() );
+  for( const auto &[key,node]: expected.nodes() ) {
+    const auto found = built.nodes().find( key );
+    BOOST_CHECK( found != built.nodes().end() );
+    if( found == built.nodes().end() ) continue;
+    BOOST_CHECK_EQUAL( found->second.get_range(), node.get_range() );
+    BOOST_CHECK_EQUAL( found->second.is_leaf(), node.is_leaf() );
+    if( found->second.is_leaf() && node.is_leaf() ) BOOST_CHECK_EQUAL( found->second.get_data(), node.get_data() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsUpdate ) {
+  std::mt19937 rng( 1u );
+  for( const auto &[width,height]: { std::make_pair( 200u, 150u ), std::make_pair( 256u, 256u ), std::make_pair( 1u, 77u ), std::make_pair( 301u, 4u ) } ) {
+    const auto raster = make_raster( width, height, rng );
+    for( unsigned int thread_count: { 1u, 4u } ) {
+      check_same( hdmap::build_from_dense< map_t >( { width, height }, raster.data(), { 1u, width }, std::nullopt, thread_count ), build_by_update( raster, width, height, std::nullopt ) );
+      check_same( hdmap::build_from_dense< map_t >( { width, height }, raster.data(), { 1u, width }, 0u, thread_count ), build_by_update( raster, width, height, 0u ) );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Strides ) {
+  // a column major raster with a padded column
+  std::vector< unsigned int > raster( 12u * 10u, 9u );
+  for( std::size_t x = 0u; x != 10u; ++x )
+    for( std::size_t y = 0u; y != 10u; ++y )
+      raster[ x * 12u + y ] = ( x + y ) % 3u;
+  const auto built = hdmap::build_from_dense< map_t >( { 10u, 10u }, raster.data(), { 12u, 1u }, 0u );
+  BOOST_CHECK_EQUAL( built.size(), 66u );
+  BOOST_CHECK_EQUAL( built.count_if( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 10u, 10u ) ), []( unsigned int v ) { return v == 9u; } ), 0u );
+  BOOST_CHECK_EQUAL( built.count_if( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 10u, 10u ) ), []( unsigned int v ) { return v == 1u; } ), 33u );
+}
+
+BOOST_AUTO_TEST_CASE( Volume ) {
+  std::vector< unsigned int > raster( 64u * 64u * 64u, 1u );
+  for( std::size_t i = 0u; i < raster.size(); i += 997u ) raster[ i ] = 2u;
+  const auto built = hdmap::build_from_dense< map3_t >( { 64u, 64u, 64u }, raster.data(), { 1u, 64u, 64u * 64u }, std::nullopt, 3u );
+  map3_t expected;
+  expected.update( map3_t::rect( map3_t::enc( 0u, 0u, 0u ), map3_t::enc( 64u, 64u, 64u ) ), 1u );
+  for( std::size_t i = 0u; i < raster.size(); i += 997u )
+    expected.update( map3_t::rect( map3_t::enc( i % 64u, i / 64u % 64u, i / 4096u ), map3_t::enc( i % 64u + 1u, i / 64u % 64u + 1u, i / 4096u + 1u ) ), 2u );
+  // expected keeps the leaves split by the updates as inherited nodes
+  BOOST_CHECK_EQUAL( std::ranges::distance( built.leaves() ), std::ranges::distance( expected.leaves() ) );
+  BOOST_CHECK_EQUAL( built.size(), expected.size() );
+  BOOST_CHECK_EQUAL( built.count_if( map3_t::rect( map3_t::enc( 0u, 0u, 0u ), map3_t::enc( 64u, 64u, 64u ) ), []( unsigned int v ) { return v == 2u; } ), ( raster.size() + 996u ) / 997u );
+  BOOST_CHECK_THROW( ( hdmap::build_from_dense< map3_t >( { 513u, 1u, 1u }, raster.data(), { 1u, 1u, 1u } ) ), std::out_of_range );
+}
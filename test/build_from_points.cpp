@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE build_from_points
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/bulk_load.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+using map3_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+
+// The leaves of the map with the children holding an inherited value
+template< typename M >
+auto get_leaves( const M &map ) {
+  std::vector< std::tuple< typename M::key_type, typename M::key_type, unsigned int > > leaves;
+  for( const auto &[range,value]: map.leaves() ) leaves.emplace_back( range.left_top, range.right_bottom, value );
+  std::sort( leaves.begin(), leaves.end() );
+  return leaves;
+}
+
+// The updates split the leaves lazily, so the leaves are compared instead of the nodes stored
+template< typename M >
+void check_same( const M &built, const M &expected ) {
+  BOOST_CHECK_EQUAL( built.size(), expected.size() );
+  BOOST_CHECK( get_leaves( built ) == get_leaves( expected ) );
+}
+
+// The map made by updating each voxel in turn
+template< typename M >
+M build_by_update( const std::vector< std::pair< typename M::key_type, unsigned int > > &points ) {
+  M map;
+  for( const auto &[key,value]: points ) {
+    auto right_bottom = key;
+    for( unsigned int i = 0u; i != hdmap::detail::hdmap_dims_v< M >; ++i )
+      hdmap::detail::set_component< typename M::key_type, hdmap::detail::hdmap_dims_v< M > >( i, right_bottom, hdmap::detail::get_component< typename M::key_type, hdmap::detail::hdmap_dims_v< M > >( i, key ) + 1u );
+    map.update( M::rect( key, right_bottom ), unsigned( value ) );
+  }
+  return map;
+}
+
+BOOST_AUTO_TEST_CASE( SameAsUpdate ) {
+  std::mt19937 rng( 1u );
+  // dense clusters fill whole blocks, and the scattered points and duplicates exercise the rest
+  std::vector< std::pair< map_t::key_type, unsigned int > > points;
+  std::uniform_int_distribution< unsigned int > position( 0u, 16383u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 1u );
+  for( unsigned int i = 0u; i != 8u; ++i ) {
+    const auto x = position( rng ) & ~0x3Fu;
+    const auto y = position( rng ) & ~0x3Fu;
+    const auto v = value( rng );
+    for( unsigned int j = 0u; j != 64u; ++j )
+      for( unsigned int k = 0u; k != 64u; ++k )
+        points.emplace_back( map_t::enc( x + k, y + j ), v );
+  }
+  for( unsigned int i = 0u; i != 4000u; ++i ) points.emplace_back( map_t::enc( position( rng ), position( rng ) ), value( rng ) );
+  std::shuffle( points.begin(), points.end(), rng );
+  for( unsigned int i = 0u; i != 2000u; ++i ) points.push_back( points[ i * 7u ] );
+  for( unsigned int i = 0u; i != 2000u; ++i ) points.emplace_back( points[ i * 11u ].first, value( rng ) );
+  const auto expected = build_by_update< map_t >( points );
+  for( unsigned int thread_count: { 1u, 3u, 8u } )
+    check_same( hdmap::build_from_points< map_t >( points, thread_count ), expected );
+}
+
+BOOST_AUTO_TEST_CASE( Volume ) {
+  std::mt19937 rng( 2u );
+  std::vector< std::pair< map3_t::key_type, unsigned int > > points;
+  std::uniform_int_distribution< unsigned int > position( 0u, 511u );
+  for( unsigned int i = 0u; i != 12000u; ++i ) points.emplace_back( map3_t::enc( position( rng ) / 8u, position( rng ), position( rng ) / 4u ), i % 3u );
+  const auto expected = build_by_update< map3_t >( points );
+  for( unsigned int thread_count: { 1u, 4u } )
+    check_same( hdmap::build_from_points< map3_t >( points, thread_count ), expected );
+}
+
+BOOST_AUTO_TEST_CASE( Edges ) {
+  std::vector< std::pair< map_t::key_type, unsigned int > > points;
+  BOOST_CHECK( hdmap::build_from_points< map_t >( points ).empty() );
+  points.emplace_back( map_t::enc( 3u, 5u ), 1u );
+  const auto single = hdmap::build_from_points< map_t >( points );
+  BOOST_CHECK_EQUAL( single.size(), 1u );
+  BOOST_CHECK( single.any( map_t::rect( map_t::enc( 3u, 5u ), map_t::enc( 4u, 6u ) ) ) );
+  points.emplace_back( map_t::enc( 16384u, 0u ), 1u );
+  BOOST_CHECK_THROW( hdmap::build_from_points< map_t >( points ), std::out_of_range );
+}
@@ -0,0 +1,114 @@
+#define BOOST_TEST_MODULE concurrent
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <hdmap/concurrent.hpp>
+#include <cstdint>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::persistent_underlying_container_t< std::uint32_t, unsigned int, 2u > >;
+
+BOOST_AUTO_TEST_CASE( ReadersSeeWholeWrites ) {
+  hdmap::concurrent_hdmap< map_t > map;
+  map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 128u, 128u ) ), 0u );
+  constexpr unsigned int reader_count = 4u;
+  constexpr unsigned int step_count = 100u;
+  std::atomic< bool > done( false );
+  std::atomic< unsigned int > errors( 0u );
+  std::atomic< unsigned int > reads( 0u );
+  std::vector< std::thread > readers;
+  for( unsigned int i = 0u; i != reader_count; ++i ) {
+    readers.emplace_back(
+      [&, i]() {
+        const auto reader = map.get_reader();
+        std::mt19937 rng( i );
+        std::uniform_int_distribution< unsigned int > position( 0u, 127u );
+        unsigned int last = 0u;
+        do {
+          reader.read(
+            [&]( const map_t &snapshot ) {
+              // each write overwrites the whole square in pieces, so a snapshot holds one value only
+              const auto key = map_t::enc( position( rng ), position( rng ) );
+              const map_t::mapped_type *value = nullptr;
+              snapshot.find_points( std::span< const map_t::key_type >( &key, 1u ), std::span< const map_t::mapped_type* >( &value, 1u ) );
+              if( !value || *value < last ) {
+                ++errors;
+                return;
+              }
+              last = *value;
+              std::size_t voxels = 0u;
+              snapshot.find(
+                snapshot.rect( snapshot.enc( 0u, 0u ), snapshot.enc( 128u, 128u ) ),
+                [&]( const auto &range, const auto &v ) {
+                  if( v != last ) ++errors;
+                  voxels += hdmap::detail::get_max_leaf_count( range );
+                }
+              );
+              if( voxels != 128u * 128u ) ++errors;
+            }
+          );
+          ++reads;
+        } while( !done.load() );
+      }
+    );
+  }
+  std::mt19937 rng( 42u );
+  std::uniform_int_distribution< unsigned int > cut( 1u, 127u );
+  for( unsigned int step = 1u; step != step_count; ++step ) {
+    map.write(
+      [&]( map_t &m ) {
+        const auto x = cut( rng );
+        const auto y = cut( rng );
+        m.update( m.rect( m.enc( 0u, 0u ), m.enc( x, y ) ), map_t::mapped_type( step ) );
+        m.update( m.rect( m.enc( x, 0u ), m.enc( 128u, y ) ), map_t::mapped_type( step ) );
+        m.update( m.rect( m.enc( 0u, y ), m.enc( x, 128u ) ), map_t::mapped_type( step ) );
+        m.update( m.rect( m.enc( x, y ), m.enc( 128u, 128u ) ), map_t::mapped_type( step ) );
+      }
+    );
+  }
+  done.store( true );
+  for( auto &reader: readers ) reader.join();
+  BOOST_CHECK_EQUAL( errors.load(), 0u );
+  BOOST_CHECK( reads.load() >= reader_count );
+  map.reclaim();
+}
+
+BOOST_AUTO_TEST_CASE( ReaderSlots ) {
+  hdmap::concurrent_hdmap< map_t > map( map_t(), 2u );
+  {
+    const auto r1 = map.get_reader();
+    const auto r2 = map.get_reader();
+    BOOST_CHECK_THROW( map.get_reader(), std::length_error );
+  }
+  const auto r3 = map.get_reader();
+  map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 3u, 5u ) ), 7u );
+  BOOST_CHECK_EQUAL( r3.read( []( const map_t &m ) { return m.size(); } ), 15u );
+  BOOST_CHECK_EQUAL( map.get().size(), 15u );
+  map.erase( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 3u, 1u ) ) );
+  BOOST_CHECK_EQUAL( r3.read( []( const map_t &m ) { return m.size(); } ), 12u );
+}
+
+BOOST_AUTO_TEST_CASE( NestedRead ) {
+  hdmap::concurrent_hdmap< map_t > map;
+  map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 4u, 4u ) ), 1u );
+  const auto r = map.get_reader();
+  r.read(
+    [&]( const map_t &outer ) {
+      BOOST_CHECK_EQUAL( r.read( []( const map_t &m ) { return m.size(); } ), 16u );
+      // the inner read has returned, and the outer snapshot is retired and reclaimed while it is still read
+      map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 8u, 8u ) ), 2u );
+      map.reclaim();
+      BOOST_CHECK_EQUAL( outer.size(), 16u );
+      std::vector< map_t::value_type > found;
+      outer.find( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 8u, 8u ) ), found );
+      BOOST_REQUIRE_EQUAL( found.size(), 1u );
+      BOOST_CHECK_EQUAL( found[ 0 ].second, 1u );
+      BOOST_CHECK_EQUAL( r.read( []( const map_t &m ) { return m.size(); } ), 64u );
+    }
+  );
+}
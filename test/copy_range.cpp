@@ -14,7 +14,7 @@ BOOST_AUTO_TEST_CASE( Trimmed ) {
   unsigned int count = 0u;
   std::vector< std::uint64_t > range;
   std::vector< std::string > data;
-  for( auto &[r,value]: std::views::all( copied )|hdmap::views::leaf ) {
+  for( const auto &[r,value]: std::views::all( copied )|hdmap::views::leaf ) {
     ++count;
     data.push_back( value.get_data() );
     range.push_back( value.get_range() );
@@ -39,7 +39,7 @@ BOOST_AUTO_TEST_CASE( NotTrimmed ) {
   unsigned int count = 0u;
   std::vector< std::uint64_t > range;
   std::vector< std::string > data;
-  for( auto &[r,value]: std::views::all( copied )|hdmap::views::leaf ) {
+  for( const auto &[r,value]: std::views::all( copied )|hdmap::views::leaf ) {
     ++count;
     data.push_back( value.get_data() );
     range.push_back( value.get_range() );
@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE count
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+// count the voxels of range by visiting every leaf
+template< typename M, typename F >
+std::size_t count_leaves( const M &map, const typename M::rect_type &range, F pred ) {
+  std::size_t count = 0u;
+  for( const auto &v: map.leaves() ) {
+    if( pred( v.second ) ) count += hdmap::detail::get_overlap_count( v.first, range );
+  }
+  return count;
+}
+
+template< typename M >
+void check_count( unsigned int seed ) {
+  M map;
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 120u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 30u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  const auto random_rect = [&]() {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    return map.rect( map.enc( x, y ), map.enc( x + size( rng ), y + size( rng ) ) );
+  };
+  const auto odd = []( unsigned int v ) { return v % 2u == 1u; };
+  for( unsigned int i = 0u; i != 40u; ++i ) {
+    if( i % 4u == 3u ) map.erase( random_rect() );
+    else map.update( random_rect(), unsigned( value( rng ) ) );
+    for( unsigned int j = 0u; j != 4u; ++j ) {
+      const auto range = random_rect();
+      const auto expected = count_leaves( map, range, []( unsigned int ) { return true; } );
+      BOOST_REQUIRE_EQUAL( map.count( range ), expected );
+      BOOST_REQUIRE_EQUAL( map.count_if( range, odd ), count_leaves( map, range, odd ) );
+      BOOST_REQUIRE_EQUAL( map.any( range ), expected != 0u );
+    }
+  }
+  const auto whole = map.rect( map.enc( 0u, 0u ), map.enc( 16384u, 16384u ) );
+  BOOST_CHECK_EQUAL( map.count( whole ), map.size() );
+  map.clear();
+  BOOST_CHECK_EQUAL( map.count( whole ), 0u );
+  BOOST_CHECK( !map.any( whole ) );
+}
+
+BOOST_AUTO_TEST_CASE( Count ) {
+  for( unsigned int seed = 0u; seed != 2u; ++seed ) {
+    check_count< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u > >( seed );
+    check_count< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u >, hdmap::count_aggregate > >( seed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Any ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+  map_t map;
+  map.update( map_t::rect( map_t::enc( 10u, 20u, 30u ), map_t::enc( 11u, 21u, 31u ) ), 1u );
+  map.update( map_t::rect( map_t::enc( 0u, 0u, 0u ), map_t::enc( 64u, 64u, 8u ) ), 2u );
+  BOOST_CHECK( map.any( map_t::rect( map_t::enc( 10u, 20u, 30u ), map_t::enc( 11u, 21u, 31u ) ) ) );
+  BOOST_CHECK( map.any( map_t::rect( map_t::enc( 5u, 5u, 25u ), map_t::enc( 15u, 25u, 35u ) ) ) );
+  BOOST_CHECK( !map.any( map_t::rect( map_t::enc( 11u, 20u, 30u ), map_t::enc( 20u, 21u, 31u ) ) ) );
+  BOOST_CHECK( !map.any( map_t::rect( map_t::enc( 64u, 0u, 0u ), map_t::enc( 512u, 512u, 512u ) ) ) );
+  BOOST_CHECK( map.any( map_t::rect( map_t::enc( 63u, 63u, 7u ), map_t::enc( 512u, 512u, 512u ) ) ) );
+  BOOST_CHECK_EQUAL( map.count( map_t::rect( map_t::enc( 0u, 0u, 0u ), map_t::enc( 512u, 512u, 512u ) ) ), 64u * 64u * 8u + 1u );
+  BOOST_CHECK_EQUAL( map.count_if( map_t::rect( map_t::enc( 0u, 0u, 0u ), map_t::enc( 512u, 512u, 512u ) ), []( unsigned int v ) { return v == 1u; } ), 1u );
+}
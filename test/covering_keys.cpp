@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE covering_keys
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+// visits every child like the insert used to
+template< typename T, unsigned int dims, typename R >
+void collect_covering_keys_by_scan( T key, const R &range, std::vector< T > &dest ) {
+  using L = hdmap::detail::extract_key_type_t< R >;
+  const auto key_range = hdmap::detail::to_rectangle< L, dims >( key );
+  const auto overlap = hdmap::detail::get_overlap_count( key_range, range );
+  if( overlap == 0u ) return;
+  if( overlap == hdmap::detail::get_max_leaf_count< L, dims >( key_range.left_top ) ) {
+    dest.push_back( key );
+    return;
+  }
+  auto child_key = hdmap::detail::get_key_in_depth< T, dims >( hdmap::detail::get_depth< T, dims >( key ) - 1u, key );
+  for( unsigned int i = 0u; i != hdmap::detail::get_max_child_count< dims >(); ++i ) {
+    collect_covering_keys_by_scan< T, dims >( child_key, range, dest );
+    child_key = hdmap::detail::next_key< T, dims >( child_key, 1u );
+  }
+}
+
+template< typename T, unsigned int dims >
+void check_covering_keys( unsigned int extent ) {
+  using map_t = hdmap::hdmap< T, unsigned int, dims >;
+  using rect_t = typename map_t::rect_type;
+  using L = typename map_t::key_type;
+  std::mt19937 rng( 1u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, extent );
+  const auto root_key = hdmap::detail::get_root_key< T, dims >();
+  for( unsigned int i = 0u; i != 60u; ++i ) {
+    rect_t range{ hdmap::detail::to_key< L, dims >( 0u ), hdmap::detail::to_key< L, dims >( 0u ) };
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      auto begin = dist( rng );
+      auto end = dist( rng );
+      if( begin > end ) std::swap( begin, end );
+      hdmap::detail::set_component< L, dims >( j, range.left_top, begin );
+      hdmap::detail::set_component< L, dims >( j, range.right_bottom, end );
+    }
+    std::vector< T > expected;
+    collect_covering_keys_by_scan< T, dims >( root_key, range, expected );
+    std::vector< T > keys;
+    hdmap::detail::for_each_covering_key< T, dims >(
+      root_key,
+      range,
+      [&]( T key ) {
+        keys.push_back( key );
+        return true;
+      }
+    );
+    BOOST_REQUIRE_EQUAL( keys.size(), expected.size() );
+    for( std::size_t j = 0u; j != keys.size(); ++j )
+      BOOST_CHECK_EQUAL( keys[ j ], expected[ j ] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsScan ) {
+  check_covering_keys< std::uint32_t, 1u >( 16384u );
+  check_covering_keys< std::uint32_t, 2u >( 300u );
+  check_covering_keys< std::uint32_t, 3u >( 48u );
+  check_covering_keys< std::uint16_t, 2u >( 128u );
+}
+
+BOOST_AUTO_TEST_CASE( Stop ) {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  const auto range = map_t::rect( map_t::enc( 3u, 5u ), map_t::enc( 100u, 70u ) );
+  unsigned int count = 0u;
+  const bool completed = hdmap::detail::for_each_covering_key< std::uint32_t, 2u >(
+    hdmap::detail::get_root_key< std::uint32_t, 2u >(),
+    range,
+    [&]( std::uint32_t ) {
+      return ++count != 5u;
+    }
+  );
+  BOOST_CHECK( !completed );
+  BOOST_CHECK_EQUAL( count, 5u );
+}
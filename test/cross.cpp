@@ -5,6 +5,8 @@
 #include <hdmap/cross.hpp>
 #include <hdmap/json.hpp>
 #include <cstdint>
+#include <random>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_CASE( Cross ) {
@@ -44,3 +46,145 @@ BOOST_AUTO_TEST_CASE( CrossInRectRegion ) {
   BOOST_CHECK_EQUAL( rects[ 0 ].second.second, "world" );
 }
 
+
+using random_map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+
+random_map_t random_map( unsigned int seed ) {
+  random_map_t map;
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 60u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 20u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  for( unsigned int i = 0u; i != 30u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto range = map.rect( map.enc( x, y ), map.enc( x + size( rng ), y + size( rng ) ) );
+    if( i % 4u == 3u ) map.erase( range );
+    else map.update( range, unsigned( value( rng ) ) );
+  }
+  return map;
+}
+
+const unsigned int *find_point( const random_map_t &map, unsigned int x, unsigned int y ) {
+  const auto point = map.enc( x, y );
+  const unsigned int *value = nullptr;
+  map.find_points( std::span< const random_map_t::key_type >( &point, 1u ), std::span< const unsigned int* >( &value, 1u ) );
+  return value;
+}
+
+// compare each voxel of the result with the values of the voxels it was made from
+template< typename M, typename F >
+void check_cross( const M &c, const random_map_t &a, const random_map_t &b, F &&source ) {
+  const auto point_count = 96u * 96u;
+  std::vector< typename M::key_type > points;
+  for( unsigned int y = 0u; y != 96u; ++y )
+    for( unsigned int x = 0u; x != 96u; ++x )
+      points.push_back( c.enc( x, y ) );
+  std::vector< const std::pair< unsigned int, unsigned int >* > values( point_count );
+  c.find_points( points, values );
+  for( unsigned int i = 0u; i != point_count; ++i ) {
+    const auto [lx,ly,rx,ry,valid] = source( i % 96u, i / 96u );
+    const auto lvalue = valid ? find_point( a, lx, ly ) : nullptr;
+    const auto rvalue = valid ? find_point( b, rx, ry ) : nullptr;
+    if( lvalue && rvalue ) {
+      BOOST_REQUIRE( values[ i ] );
+      BOOST_CHECK_EQUAL( values[ i ]->first, *lvalue );
+      BOOST_CHECK_EQUAL( values[ i ]->second, *rvalue );
+    }
+    else BOOST_REQUIRE( !values[ i ] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CrossRandom ) {
+  for( unsigned int seed = 0u; seed != 3u; ++seed ) {
+    const auto a = random_map( seed * 2u );
+    const auto b = random_map( seed * 2u + 1u );
+    const auto c = hdmap::cross( a, b );
+    check_cross( c, a, b, []( unsigned int x, unsigned int y ) { return std::make_tuple( x, y, x, y, true ); } );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CrossInRectRegionRandom ) {
+  for( unsigned int seed = 0u; seed != 3u; ++seed ) {
+    const auto a = random_map( seed * 2u );
+    const auto b = random_map( seed * 2u + 1u );
+    const auto c = hdmap::cross(
+      a,
+      b,
+      a.rect( a.enc( 13u, 5u ), a.enc( 70u, 50u ) ),
+      b.rect( b.enc( 2u, 21u ), b.enc( 59u, 66u ) )
+    );
+    check_cross(
+      c,
+      a,
+      b,
+      []( unsigned int x, unsigned int y ) {
+        return std::make_tuple( x + 13u, y + 5u, x + 2u, y + 21u, x < 57u && y < 45u );
+      }
+    );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CrossMany ) {
+  for( unsigned int seed = 0u; seed != 3u; ++seed ) {
+    const auto a = random_map( seed * 4u );
+    const auto b = random_map( seed * 4u + 1u );
+    const auto c = random_map( seed * 4u + 2u );
+    const auto d = random_map( seed * 4u + 3u );
+    const auto three = hdmap::cross( a, b, c );
+    const auto four = hdmap::cross( a, b, c, d );
+    std::size_t three_count = 0u;
+    std::size_t four_count = 0u;
+    for( unsigned int y = 0u; y != 96u; ++y ) {
+      for( unsigned int x = 0u; x != 96u; ++x ) {
+        const auto point = three.enc( x, y );
+        const std::tuple< unsigned int, unsigned int, unsigned int > *three_value = nullptr;
+        three.find_points( std::span( &point, 1u ), std::span( &three_value, 1u ) );
+        const std::tuple< unsigned int, unsigned int, unsigned int, unsigned int > *four_value = nullptr;
+        four.find_points( std::span( &point, 1u ), std::span( &four_value, 1u ) );
+        const auto av = find_point( a, x, y );
+        const auto bv = find_point( b, x, y );
+        const auto cv = find_point( c, x, y );
+        const auto dv = find_point( d, x, y );
+        BOOST_REQUIRE_EQUAL( bool( three_value ), av && bv && cv );
+        if( three_value ) {
+          BOOST_CHECK( *three_value == std::make_tuple( *av, *bv, *cv ) );
+          ++three_count;
+        }
+        BOOST_REQUIRE_EQUAL( bool( four_value ), av && bv && cv && dv );
+        if( four_value ) {
+          BOOST_CHECK( *four_value == std::make_tuple( *av, *bv, *cv, *dv ) );
+          ++four_count;
+        }
+      }
+    }
+    BOOST_CHECK_EQUAL( three.size(), three_count );
+    BOOST_CHECK_EQUAL( four.size(), four_count );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CrossMixedKeyTypes ) {
+  using small_map_t = ::hdmap::hdmap< std::uint16_t, unsigned int, 2u >;
+  const auto a = random_map( 5u );
+  small_map_t b;
+  b.update( b.rect( b.enc( 3u, 10u ), b.enc( 40u, 30u ) ), 1u );
+  b.update( b.rect( b.enc( 20u, 0u ), b.enc( 30u, 60u ) ), 2u );
+  const auto c = hdmap::cross( a, b );
+  std::size_t count = 0u;
+  for( unsigned int y = 0u; y != 64u; ++y ) {
+    for( unsigned int x = 0u; x != 64u; ++x ) {
+      const auto point = c.enc( x, y );
+      const std::pair< unsigned int, unsigned int > *value = nullptr;
+      c.find_points( std::span( &point, 1u ), std::span( &value, 1u ) );
+      const auto av = find_point( a, x, y );
+      const unsigned int bv = ( 20u <= x && x < 30u && y < 60u ) ? 2u : ( 3u <= x && x < 40u && 10u <= y && y < 30u ) ? 1u : 0u;
+      BOOST_REQUIRE_EQUAL( bool( value ), av && bv );
+      if( value ) {
+        BOOST_CHECK_EQUAL( value->first, *av );
+        BOOST_CHECK_EQUAL( value->second, bv );
+        ++count;
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL( c.size(), count );
+}
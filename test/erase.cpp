@@ -3,6 +3,9 @@
 
 #include <hdmap/hdmap.hpp>
 #include <cstdint>
+#include <algorithm>
+#include <tuple>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_CASE( Erase ) {
@@ -42,10 +45,151 @@ BOOST_AUTO_TEST_CASE( EraseSplit ) {
   hdmap::detail::erase( uc, hdmap::detail::to_key< std::uint32_t, 2u >( 0u, 17u, 17u ) );
   {
     unsigned int count = 0u;
-    for( const auto &[key,value]: uc ) {
-      if( value.is_leaf() ) ++count;
+    for( const auto &[key,value]: std::views::all( uc )|hdmap::views::leaf ) {
+      BOOST_CHECK_EQUAL( value.get_data(), "hoge" );
+      ++count;
     }
     BOOST_CHECK_EQUAL( count, 15u );
+    // the split leaf keeps its value as the inherited value and no child is stored
+    BOOST_CHECK_EQUAL( uc.size(), 1u );
   }
 }
 
+
+BOOST_AUTO_TEST_CASE( InheritedLeavesOutliveIncrement ) {
+  hdmap::standard_underlying_container_t< std::uint32_t, std::string, 2u > uc;
+  hdmap::detail::insert( uc, "hoge", hdmap::detail::to_key< std::uint32_t, 2u >( 1u, 16u, 16u ), std::equal_to< std::string >{} );
+  hdmap::detail::erase( uc, hdmap::detail::to_key< std::uint32_t, 2u >( 0u, 17u, 17u ) );
+  const auto leaves = std::views::all( uc )|hdmap::views::leaf;
+  auto iter = leaves.begin();
+  const auto copied = iter;
+  const auto first = *iter;
+  ++iter;
+  // the leaf taken before the increment still refers to the inherited value, and an equal iterator yields the same leaf
+  BOOST_CHECK_EQUAL( first.second.get_data(), "hoge" );
+  BOOST_CHECK_EQUAL( ( *copied ).first, first.first );
+  BOOST_CHECK_EQUAL( &( *copied ).second.get_data(), &first.second.get_data() );
+  BOOST_CHECK( ( *iter ).first != first.first );
+}
+
+BOOST_AUTO_TEST_CASE( EraseHole ) {
+  hdmap::standard_underlying_container_t< std::uint32_t, std::string, 3u > uc;
+  hdmap::detail::insert( uc, "hoge", hdmap::detail::to_key< std::uint32_t, 3u >( 2u, 0u, 0u, 0u ), std::equal_to< std::string >{} );
+  const auto erased = hdmap::detail::erase( uc, hdmap::detail::to_key< std::uint32_t, 3u >( 0u, 5u, 6u, 7u ) );
+  BOOST_CHECK_EQUAL( erased, 1u );
+  unsigned int count = 0u;
+  unsigned int voxels = 0u;
+  for( const auto &[key,value]: std::views::all( uc )|hdmap::views::leaf ) {
+    ++count;
+    voxels += hdmap::detail::get_max_leaf_count< std::uint32_t, 3u >( value.get_range() );
+  }
+  // 63 siblings on each of the two levels hold the inherited value, the erased voxel is never materialized
+  BOOST_CHECK_EQUAL( count, 126u );
+  BOOST_CHECK_EQUAL( voxels, 4095u );
+  // only the two nodes on the path to the hole are stored
+  BOOST_CHECK_EQUAL( uc.size(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE( EraseAllButOneChild ) {
+  using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 1u >;
+  hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 1u > uc;
+  hdmap::detail::insert( uc, 1u, hdmap::detail::to_key< std::uint32_t, 1u >( 2u, 0u ), std::equal_to< unsigned int >{} );
+  // only a part of the last child is left on each level, so it takes the place of its parent
+  const auto erased = hdmap::detail::erase( uc, map_t::rect( map_t::enc( 0u ), map_t::enc( 15u ) ) );
+  BOOST_CHECK_EQUAL( erased, 15u );
+  BOOST_CHECK_EQUAL( uc.size(), 1u );
+  const map_t map( std::equal_to< unsigned int >{}, std::move( uc ) );
+  BOOST_CHECK_EQUAL( map.size(), 1u );
+  std::vector< map_t::key_type > points;
+  for( unsigned int x = 0u; x != 16u; ++x )
+    points.push_back( map.enc( x ) );
+  std::vector< const unsigned int* > found( points.size() );
+  map.find_points( points, found );
+  for( std::size_t i = 0u; i != points.size(); ++i )
+    BOOST_CHECK_EQUAL( bool( found[ i ] ), i == 15u );
+}
+
+BOOST_AUTO_TEST_CASE( ReadPokedLeaves ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 3u, std::equal_to< unsigned int >, hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 3u >, hdmap::sum_aggregate< unsigned int > >;
+  constexpr unsigned int width = 36u;
+  constexpr unsigned int height = 20u;
+  std::vector< unsigned int > expected( width * height * height, 0u );
+  const auto set = [&]( unsigned int x0, unsigned int y0, unsigned int z0, unsigned int x1, unsigned int y1, unsigned int z1, unsigned int value ) {
+    for( unsigned int z = z0; z != z1; ++z )
+      for( unsigned int y = y0; y != y1; ++y )
+        for( unsigned int x = x0; x != x1; ++x )
+          expected[ ( z * height + y ) * width + x ] = value;
+  };
+  map_t map;
+  map.update( map.rect( map.enc( 0u, 0u, 0u ), map.enc( 16u, 16u, 16u ) ), 1u );
+  set( 0u, 0u, 0u, 16u, 16u, 16u, 1u );
+  map.update( map.rect( map.enc( 16u, 0u, 0u ), map.enc( 32u, 16u, 16u ) ), 2u );
+  set( 16u, 0u, 0u, 32u, 16u, 16u, 2u );
+  // the leaves are split lazily, and the rest of each split leaf is read through the inherited value
+  for( const auto &[x,y,z]: { std::make_tuple( 5u, 6u, 7u ), std::make_tuple( 15u, 15u, 15u ), std::make_tuple( 20u, 3u, 9u ) } ) {
+    map.erase( map.rect( map.enc( x, y, z ), map.enc( x + 1u, y + 1u, z + 1u ) ) );
+    set( x, y, z, x + 1u, y + 1u, z + 1u, 0u );
+  }
+  map.erase( map.rect( map.enc( 8u, 0u, 4u ), map.enc( 10u, 2u, 6u ) ) );
+  set( 8u, 0u, 4u, 10u, 2u, 6u, 0u );
+  map.update( map.rect( map.enc( 1u, 1u, 1u ), map.enc( 2u, 2u, 2u ) ), 3u );
+  set( 1u, 1u, 1u, 2u, 2u, 2u, 3u );
+  BOOST_CHECK( std::any_of( map.nodes().begin(), map.nodes().end(), []( const auto &v ) { return v.second.is_inherited(); } ) );
+  const auto get_expected = [&]( const auto &key ) {
+    const auto [x,y,z] = map.dec( key );
+    return ( x < width && y < height && z < height ) ? expected[ ( z * height + y ) * width + x ] : 0u;
+  };
+  std::vector< map_t::key_type > points;
+  for( unsigned int z = 0u; z != height; ++z )
+    for( unsigned int y = 0u; y != height; ++y )
+      for( unsigned int x = 0u; x != width; ++x )
+        points.push_back( map.enc( x, y, z ) );
+  std::vector< const unsigned int* > found( points.size() );
+  map.find_points( points, found );
+  std::size_t count = 0u;
+  unsigned int sum = 0u;
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    BOOST_REQUIRE_EQUAL( found[ i ] ? *found[ i ] : 0u, expected[ i ] );
+    if( expected[ i ] ) {
+      ++count;
+      sum += expected[ i ];
+    }
+  }
+  BOOST_CHECK_EQUAL( map.size(), count );
+  const auto whole = map.rect( map.enc( 0u, 0u, 0u ), map.enc( width, height, height ) );
+  BOOST_CHECK_EQUAL( map.count( whole ), count );
+  BOOST_CHECK_EQUAL( map.count_if( whole, []( unsigned int v ) { return v == 3u; } ), 1u );
+  BOOST_CHECK_EQUAL( map.reduce( whole ), sum );
+  BOOST_CHECK_EQUAL( map.reduce( whole, hdmap::sum_aggregate< unsigned int >{} ), sum );
+  std::size_t leaf_voxels = 0u;
+  for( const auto &[range,value]: map.leaves() ) {
+    leaf_voxels += hdmap::detail::get_overlap_count( range, range );
+    BOOST_REQUIRE_EQUAL( get_expected( range.left_top ), value );
+  }
+  BOOST_CHECK_EQUAL( leaf_voxels, count );
+  std::vector< map_t::value_type > regions;
+  map.find( whole, regions );
+  std::size_t region_voxels = 0u;
+  for( const auto &[range,value]: regions ) {
+    region_voxels += hdmap::detail::get_overlap_count( range, range );
+    for( auto z = hdmap::detail::get_component< map_t::key_type, 3u >( 2u, range.left_top ); z != hdmap::detail::get_component< map_t::key_type, 3u >( 2u, range.right_bottom ); ++z )
+      for( auto y = hdmap::detail::get_component< map_t::key_type, 3u >( 1u, range.left_top ); y != hdmap::detail::get_component< map_t::key_type, 3u >( 1u, range.right_bottom ); ++y )
+        for( auto x = hdmap::detail::get_component< map_t::key_type, 3u >( 0u, range.left_top ); x != hdmap::detail::get_component< map_t::key_type, 3u >( 0u, range.right_bottom ); ++x )
+          BOOST_REQUIRE_EQUAL( get_expected( map.enc( x, y, z ) ), value );
+  }
+  BOOST_CHECK_EQUAL( region_voxels, count );
+  std::vector< unsigned int > raster( expected.size() );
+  map.rasterize( whole, raster.data(), { 1u, width, width * height }, 0u );
+  BOOST_CHECK( raster == expected );
+  // a copy of a part of a split leaf
+  const auto part = map.rect( map.enc( 4u, 4u, 4u ), map.enc( 18u, 8u, 8u ) );
+  hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 3u > copied;
+  hdmap::detail::copy( map.nodes(), part, copied, std::equal_to< unsigned int >{} );
+  const map_t copied_map( std::equal_to< unsigned int >{}, std::move( copied ) );
+  BOOST_CHECK_EQUAL( copied_map.size(), map.count( part ) );
+  copied_map.find_points( points, found );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    const auto inside = hdmap::detail::get_overlap_count( part, map.rect( points[ i ], map.enc( map.dec( points[ i ] )[ 0 ] + 1u, map.dec( points[ i ] )[ 1 ] + 1u, map.dec( points[ i ] )[ 2 ] + 1u ) ) ) != 0u;
+    BOOST_REQUIRE_EQUAL( found[ i ] ? *found[ i ] : 0u, inside ? expected[ i ] : 0u );
+  }
+}
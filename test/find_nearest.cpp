@@ -0,0 +1,45 @@
+#define BOOST_TEST_MODULE find_nearest
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+template< typename T, unsigned int dims >
+void check_find_nearest( unsigned int extent ) {
+  hdmap::standard_underlying_container_t< T, unsigned int, dims > map;
+  std::mt19937 rng( 1u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, extent - 1u );
+  const auto random_key = [&]() {
+    T key = hdmap::detail::to_key< T, dims >( 0u );
+    for( unsigned int i = 0u; i != dims; ++i )
+      hdmap::detail::set_component< T, dims >( i, key, dist( rng ) );
+    return key;
+  };
+  for( unsigned int i = 0u; i != 2000u; ++i )
+    hdmap::detail::insert( map, i % 3u, random_key(), std::equal_to< unsigned int >{} );
+  const auto &cmap = map;
+  const auto root_key = hdmap::detail::get_root_key< T, dims >();
+  for( unsigned int i = 0u; i != 5000u; ++i ) {
+    const auto key = random_key();
+    hdmap::detail::depth_log_t< T, dims > log;
+    const auto walked = hdmap::detail::find_nearest( cmap, root_key, key, log );
+    const auto searched = hdmap::detail::find_nearest( cmap, root_key, key );
+    BOOST_REQUIRE( walked != cmap.end() );
+    BOOST_CHECK( walked == searched );
+    BOOST_CHECK( hdmap::detail::find_nearest( map, root_key, key ) == map.find( walked->first ) );
+    // every logged slot depth refers to an existing ancestor
+    for( const auto depth: log ) {
+      const auto ancestor = cmap.find( depth == hdmap::detail::get_max_depth< T, dims >() ? root_key : hdmap::detail::get_key_in_depth< T, dims >( depth, key ) );
+      BOOST_CHECK( ancestor != cmap.end() );
+      BOOST_CHECK( !ancestor->second.is_leaf() );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsWalk ) {
+  check_find_nearest< std::uint32_t, 2u >( 4096u );
+  check_find_nearest< std::uint32_t, 3u >( 256u );
+  check_find_nearest< std::uint64_t, 2u >( 1u << 20u );
+}
@@ -0,0 +1,55 @@
+#define BOOST_TEST_MODULE find_points
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+template< typename M >
+void check_find_points() {
+  M map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 300u, 200u ) ), "hello" );
+  std::mt19937 rng( 3u );
+  std::uniform_int_distribution< unsigned int > dist( 0u, 319u );
+  for( unsigned int i = 0u; i != 40u; ++i ) {
+    const auto x = dist( rng );
+    const auto y = dist( rng );
+    map.update( map.rect( map.enc( x, y ), map.enc( x + 1u + i % 7u, y + 1u + i % 5u ) ), i % 2u ? "world" : "fuga" );
+  }
+  map.erase( map.rect( map.enc( 120u, 80u ), map.enc( 150u, 97u ) ) );
+  std::vector< typename M::key_type > points;
+  for( unsigned int i = 0u; i != 20000u; ++i )
+    points.push_back( map.enc( dist( rng ), dist( rng ) ) );
+  points.push_back( map.enc( 1u << 20u, 0u ) );
+  std::vector< const std::string* > found( points.size() );
+  map.find_points( points, found );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    std::vector< typename M::value_type > expected;
+    const auto [x,y] = map.dec( points[ i ] );
+    map.find( map.rect( map.enc( x, y ), map.enc( x + 1u, y + 1u ) ), expected );
+    if( expected.empty() ) {
+      BOOST_CHECK( found[ i ] == nullptr );
+    }
+    else {
+      BOOST_REQUIRE( found[ i ] != nullptr );
+      BOOST_CHECK_EQUAL( *found[ i ], expected[ 0 ].second );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsFind ) {
+  check_find_points< ::hdmap::hdmap< std::uint32_t, std::string, 2u > >();
+  check_find_points< ::hdmap::hdmap< std::uint32_t, std::string, 2u, std::equal_to< std::string >, hdmap::flat_underlying_container_t< std::uint32_t, std::string, 2u > > >();
+}
+
+BOOST_AUTO_TEST_CASE( EmptyMap ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+  map_t map;
+  std::vector< map_t::key_type > points{ map.enc( 0u, 0u ), map.enc( 5u, 3u ) };
+  std::vector< const std::string* > found( points.size(), nullptr );
+  map.find_points( points, found );
+  BOOST_CHECK( found[ 0 ] == nullptr );
+  BOOST_CHECK( found[ 1 ] == nullptr );
+}
@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE flat_container
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+static_assert( hdmap::HDMapUnderlyingContainer< hdmap::flat_underlying_container_t< std::uint32_t, std::string, 2u > > );
+
+BOOST_AUTO_TEST_CASE( InsertFindErase ) {
+  hdmap::flat_node_map< std::uint32_t, unsigned int, hdmap::key_hash< std::uint32_t, 2u > > m;
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    BOOST_CHECK( m.insert( std::make_pair( i * 7u, i ) ).second );
+  }
+  BOOST_CHECK( !m.insert( std::make_pair( 7u, 0u ) ).second );
+  BOOST_CHECK_EQUAL( m.size(), 1000u );
+  for( unsigned int i = 0u; i != 1000u; i += 2u ) {
+    BOOST_CHECK_EQUAL( m.erase( i * 7u ), 1u );
+  }
+  BOOST_CHECK_EQUAL( m.erase( 0u ), 0u );
+  BOOST_CHECK_EQUAL( m.size(), 500u );
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    const auto found = m.find( i * 7u );
+    if( i % 2u ) {
+      BOOST_CHECK( found != m.end() );
+      BOOST_CHECK_EQUAL( found->second, i );
+    }
+    else {
+      BOOST_CHECK( found == m.end() );
+    }
+  }
+  BOOST_CHECK_EQUAL( std::distance( m.begin(), m.end() ), 500 );
+  auto copied = m;
+  m.clear();
+  BOOST_CHECK( m.empty() );
+  BOOST_CHECK_EQUAL( copied.size(), 500u );
+  BOOST_CHECK( copied.find( 7u ) != copied.end() );
+}
+
+BOOST_AUTO_TEST_CASE( SameAsStandardContainer ) {
+  using flat_map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u, std::equal_to< std::string >, hdmap::flat_underlying_container_t< std::uint32_t, std::string, 2u > >;
+  using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+  flat_map_t flat;
+  map_t standard;
+  flat.update( flat.rect( flat.enc( 0u, 0u ), flat.enc( 500u, 500u ) ), "hello" );
+  standard.update( standard.rect( standard.enc( 0u, 0u ), standard.enc( 500u, 500u ) ), "hello" );
+  for( unsigned int i = 0u; i != 20u; ++i ) {
+    const auto x = 13u + i * 17u;
+    const auto y = 29u + i * 11u;
+    flat.update( flat.rect( flat.enc( x, y ), flat.enc( x + 5u, y + 3u ) ), "world" );
+    standard.update( standard.rect( standard.enc( x, y ), standard.enc( x + 5u, y + 3u ) ), "world" );
+  }
+  flat.erase( flat.rect( flat.enc( 100u, 100u ), flat.enc( 120u, 130u ) ) );
+  standard.erase( standard.rect( standard.enc( 100u, 100u ), standard.enc( 120u, 130u ) ) );
+  BOOST_CHECK_EQUAL( flat.nodes().size(), standard.nodes().size() );
+  BOOST_CHECK_EQUAL( flat.size(), standard.size() );
+  std::vector< flat_map_t::value_type > flat_rects;
+  std::vector< map_t::value_type > standard_rects;
+  flat.find( flat.rect( flat.enc( 0u, 0u ), flat.enc( 600u, 600u ) ), flat_rects );
+  standard.find( standard.rect( standard.enc( 0u, 0u ), standard.enc( 600u, 600u ) ), standard_rects );
+  BOOST_CHECK_EQUAL( flat_rects.size(), standard_rects.size() );
+  for( std::size_t i = 0u; i != std::min( flat_rects.size(), standard_rects.size() ); ++i ) {
+    BOOST_CHECK_EQUAL( flat_rects[ i ].first.left_top, standard_rects[ i ].first.left_top );
+    BOOST_CHECK_EQUAL( flat_rects[ i ].first.right_bottom, standard_rects[ i ].first.right_bottom );
+    BOOST_CHECK_EQUAL( flat_rects[ i ].second, standard_rects[ i ].second );
+  }
+}
@@ -14,12 +14,51 @@ BOOST_AUTO_TEST_CASE( Update ) {
   map.update( map.rect( map.enc( 50u, 30u ), map.enc( 52u, 33u ) ), "world" );
   map.find( map.rect( map.enc( 50u, 30u ), map.enc( 53u, 34u ) ), affected );
   BOOST_CHECK_EQUAL( affected.size(), 3u );
-  BOOST_CHECK_EQUAL( affected[ 0 ].first.left_top, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 50u, 33u ) ) );
-  BOOST_CHECK_EQUAL( affected[ 0 ].first.right_bottom, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 53u, 34u ) ) );
-  BOOST_CHECK_EQUAL( affected[ 1 ].first.left_top, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 52u, 30u ) ) );
-  BOOST_CHECK_EQUAL( affected[ 1 ].first.right_bottom, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 53u, 33u ) ) );
-  BOOST_CHECK_EQUAL( affected[ 2 ].first.left_top, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 50u, 30u ) ) );
-  BOOST_CHECK_EQUAL( affected[ 2 ].first.right_bottom, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 52u, 33u ) ) );
+  std::size_t hello_count = 0u;
+  for( const auto &[rect,value]: affected ) {
+    if( value == "world" ) {
+      BOOST_CHECK_EQUAL( rect.left_top, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 50u, 30u ) ) );
+      BOOST_CHECK_EQUAL( rect.right_bottom, ( hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 52u, 33u ) ) );
+    }
+    else {
+      BOOST_CHECK_EQUAL( value, "hello" );
+      hello_count += hdmap::detail::get_max_leaf_count< std::uint64_t, 2u >( rect );
+    }
+    for( const auto &[other,other_value]: affected ) {
+      if( &other != &rect ) {
+        BOOST_CHECK_EQUAL( ( hdmap::detail::get_overlap_count< std::uint64_t, 2u >( rect, other ) ), 0u );
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL( hello_count, 6u );
   BOOST_CHECK_EQUAL( map.size(), 250000u );
 }
 
+
+BOOST_AUTO_TEST_CASE( FindWithCallback ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+  map_t map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 500u, 500u ) ), "hello" );
+  map.update( map.rect( map.enc( 50u, 30u ), map.enc( 52u, 33u ) ), "world" );
+  for( auto mode: { hdmap::decomposition_mode_t::FEWEST, hdmap::decomposition_mode_t::FASTEST } ) {
+    std::vector< map_t::value_type > expected;
+    map.find( map.rect( map.enc( 40u, 20u ), map.enc( 70u, 60u ) ), expected, mode );
+    std::vector< map_t::value_type > streamed;
+    std::size_t count = 0u;
+    map.find(
+      map.rect( map.enc( 40u, 20u ), map.enc( 70u, 60u ) ),
+      [&]( const map_t::rect_type &rect, const std::string &value ) {
+        streamed.emplace_back( rect, value );
+        count += hdmap::detail::get_max_leaf_count< std::uint64_t, 2u >( rect );
+      },
+      mode
+    );
+    BOOST_CHECK_EQUAL( count, 30u * 40u );
+    BOOST_CHECK_EQUAL( streamed.size(), expected.size() );
+    for( std::size_t i = 0u; i != std::min( streamed.size(), expected.size() ); ++i ) {
+      BOOST_CHECK_EQUAL( streamed[ i ].first.left_top, expected[ i ].first.left_top );
+      BOOST_CHECK_EQUAL( streamed[ i ].first.right_bottom, expected[ i ].first.right_bottom );
+      BOOST_CHECK_EQUAL( streamed[ i ].second, expected[ i ].second );
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#define BOOST_TEST_MODULE intersecting_view
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE( IntersectingView ) {
+  hdmap::standard_underlying_container_t< std::uint32_t, std::string, 2u > uc;
+  hdmap::detail::insert( uc, "fuga", hdmap::detail::to_key< std::uint32_t, 2u >( 6u, 0x0u, 0x0u ), std::equal_to< std::string >{} );
+  hdmap::detail::update( uc, "hoge", hdmap::rectangle< std::uint64_t, 2u >{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 281u, 256u ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 282u, 257u ) }, std::equal_to< std::string >{} );
+  const hdmap::rectangle< std::uint64_t, 2u > range{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 281u, 254u ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 282u, 258u ) };
+  std::vector< std::pair< std::uint32_t, std::string > > expected;
+  for( const auto &[key,value]: std::views::all( uc )|hdmap::views::leaf|hdmap::views::rectangle( range ) ) {
+    expected.emplace_back( value.get_range(), value.get_data() );
+  }
+  std::vector< std::pair< std::uint32_t, std::string > > found;
+  for( const auto &[key,value]: hdmap::views::intersecting( uc, range )|hdmap::views::leaf ) {
+    found.emplace_back( value.get_range(), value.get_data() );
+  }
+  BOOST_CHECK_EQUAL( found.size(), 3u );
+  std::sort( expected.begin(), expected.end() );
+  std::sort( found.begin(), found.end() );
+  BOOST_CHECK( found == expected );
+  std::size_t count = 0u;
+  for( const auto &[rect,value]: hdmap::views::intersecting( uc, range )|hdmap::views::leaf|hdmap::views::node ) {
+    count += hdmap::detail::get_overlap_count< std::uint64_t, 2u >( rect, range );
+  }
+  BOOST_CHECK_EQUAL( count, 4u );
+}
+
+BOOST_AUTO_TEST_CASE( IntersectingViewEmpty ) {
+  hdmap::standard_underlying_container_t< std::uint32_t, std::string, 2u > uc;
+  const hdmap::rectangle< std::uint64_t, 2u > range{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 281u, 254u ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 282u, 258u ) };
+  auto view = hdmap::views::intersecting( uc, range );
+  BOOST_CHECK( view.begin() == view.end() );
+}
@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE morton
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/morton.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+static_assert( std::is_same_v< hdmap::detail::morton_key_t< std::uint32_t, 2u >, std::uint32_t > );
+static_assert( std::is_same_v< hdmap::detail::morton_key_t< std::uint32_t, 3u >, std::uint64_t > );
+static_assert( hdmap::from_morton_key< std::uint32_t, 2u >( hdmap::to_morton_key< std::uint32_t, 2u >( hdmap::detail::to_key< std::uint32_t, 2u >( 2u, 48u, 16u ) ) ) == hdmap::detail::to_key< std::uint32_t, 2u >( 2u, 48u, 16u ) );
+
+// Random keys inside the root, at every depth
+template< typename T, unsigned int dims >
+std::vector< T > get_keys( std::size_t count ) {
+  std::mt19937 rng( 1u );
+  constexpr auto max_depth = hdmap::detail::get_max_depth< T, dims >();
+  std::vector< T > keys;
+  for( std::size_t i = 0u; i != count; ++i ) {
+    const unsigned int depth = std::uniform_int_distribution< unsigned int >( 0u, max_depth )( rng );
+    T key = hdmap::detail::to_key< T, dims >( depth );
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      const std::uint64_t component = std::uniform_int_distribution< std::uint64_t >( 0u, hdmap::detail::get_component_max< T, dims >() )( rng );
+      hdmap::detail::set_component< T, dims >( j, key, T( component ) );
+    }
+    keys.push_back( key );
+  }
+  return keys;
+}
+
+template< typename T, unsigned int dims >
+void check_conversion() {
+  for( const auto key: get_keys< T, dims >( 1000u ) ) {
+    const auto code = hdmap::detail::get_morton_code< T, dims >( key );
+    BOOST_CHECK_EQUAL( code, ( hdmap::detail::get_morton_code_portable< T, dims >( key ) ) );
+    const auto depth = hdmap::detail::get_depth< T, dims >( key );
+    BOOST_CHECK_EQUAL( ( hdmap::detail::from_morton_code< T, dims >( code, depth ) ), key );
+    BOOST_CHECK_EQUAL( ( hdmap::detail::from_morton_code_portable< T, dims >( code, depth ) ), key );
+    const auto morton = hdmap::to_morton_key< T, dims >( key );
+    const auto decoded = hdmap::from_morton_key< T, dims >( morton );
+    BOOST_CHECK_EQUAL( decoded, key );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Conversion ) {
+  check_conversion< std::uint16_t, 2u >();
+  check_conversion< std::uint32_t, 2u >();
+  check_conversion< std::uint32_t, 3u >();
+  check_conversion< std::uint64_t, 2u >();
+  check_conversion< std::uint64_t, 3u >();
+}
+
+BOOST_AUTO_TEST_CASE( Order ) {
+  using T = std::uint32_t;
+  constexpr unsigned int dims = 2u;
+  auto keys = get_keys< T, dims >( 300u );
+  std::sort( keys.begin(), keys.end(), []( T l, T r ) { return hdmap::to_morton_key< T, dims >( l ) < hdmap::to_morton_key< T, dims >( r ); } );
+  for( std::size_t i = 0u; i != keys.size(); ++i ) {
+    for( std::size_t j = i + 1u; j != keys.size(); ++j ) {
+      // a key comes before the keys inside it
+      BOOST_CHECK( ( !hdmap::detail::contains< T, dims >( keys[ j ], keys[ i ] ) || keys[ i ] == keys[ j ] ) );
+    }
+    // the voxels of neighbouring keys increase along the Z-order curve
+    if( i + 1u != keys.size() ) {
+      const auto code = hdmap::detail::get_morton_code< T, dims >( keys[ i ] );
+      const auto next = hdmap::detail::get_morton_code< T, dims >( keys[ i + 1u ] );
+      BOOST_CHECK_LE( code, next );
+    }
+  }
+  const auto code = []( unsigned int x, unsigned int y ) {
+    return hdmap::detail::get_morton_code< T, dims >( hdmap::detail::to_key< T, dims >( 0u, x, y ) );
+  };
+  BOOST_CHECK_EQUAL( code( 1u, 0u ), 1u );
+  BOOST_CHECK_EQUAL( code( 0u, 1u ), 4u );
+  BOOST_CHECK_EQUAL( code( 4u, 0u ), 16u );
+}
+
+template< typename M >
+std::vector< std::tuple< std::uint64_t, std::uint64_t, std::string > > get_rects( const M &map ) {
+  std::vector< typename M::value_type > found;
+  map.find( map.rect( map.enc( 0u, 0u ), map.enc( 1024u, 1024u ) ), found );
+  std::vector< std::tuple< std::uint64_t, std::uint64_t, std::string > > rects;
+  for( const auto &v: found ) rects.emplace_back( v.first.left_top, v.first.right_bottom, v.second );
+  std::sort( rects.begin(), rects.end() );
+  return rects;
+}
+
+BOOST_AUTO_TEST_CASE( Map ) {
+  using T = std::uint32_t;
+  constexpr unsigned int dims = 2u;
+  ::hdmap::hdmap< T, std::string, dims > expected;
+  ::hdmap::hdmap< T, std::string, dims, std::equal_to< std::string >, hdmap::persistent_underlying_container_t< T, std::string, dims, hdmap::morton_key_hash< T, dims > > > persistent;
+  std::mt19937 rng( 2u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 200u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 40u );
+  for( unsigned int i = 0u; i != 200u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto range = expected.rect( expected.enc( x, y ), expected.enc( x + size( rng ), y + size( rng ) ) );
+    if( i % 5u == 4u ) {
+      expected.erase( range );
+      persistent.erase( range );
+    }
+    else {
+      const auto value = std::to_string( i % 7u );
+      expected.update( range, std::string( value ) );
+      persistent.update( range, std::string( value ) );
+    }
+  }
+  BOOST_CHECK( get_rects( persistent ) == get_rects( expected ) );
+  BOOST_CHECK_EQUAL( persistent.size(), expected.size() );
+}
+
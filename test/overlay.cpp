@@ -0,0 +1,143 @@
+#define BOOST_TEST_MODULE overlay
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/overlay.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+
+map_t random_map( unsigned int seed ) {
+  map_t map;
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 60u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 30u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  for( unsigned int i = 0u; i != 30u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto range = map.rect( map.enc( x, y ), map.enc( x + size( rng ), y + size( rng ) ) );
+    if( i % 4u == 3u ) map.erase( range );
+    else map.update( range, unsigned( value( rng ) ) );
+  }
+  return map;
+}
+
+std::vector< const unsigned int* > get_voxels( const map_t &map ) {
+  std::vector< map_t::key_type > points;
+  for( unsigned int y = 0u; y != 96u; ++y )
+    for( unsigned int x = 0u; x != 96u; ++x )
+      points.push_back( map.enc( x, y ) );
+  std::vector< const unsigned int* > values( points.size() );
+  map.find_points( points, values );
+  return values;
+}
+
+// no internal node could be merged into a leaf or replaced by its only child
+// The children holding the inherited value count as leaves of an inherited node.
+void check_merged( const map_t &map ) {
+  for( const auto &[key,node]: map.nodes() ) {
+    if( node.is_leaf() ) continue;
+    const auto inherited = unsigned( std::popcount( node.get_inherited_children() ) );
+    BOOST_REQUIRE_GT( node.get_count() + inherited, 1u );
+    if( inherited == hdmap::detail::get_max_child_count< 2u >() ) BOOST_FAIL( "an inherited node without children is a leaf" );
+    if( inherited ) {
+      // a child equal to the inherited value is left out
+      hdmap::detail::for_each_child(
+        map.nodes(),
+        node,
+        [&]( const auto &child_node, auto ) {
+          BOOST_REQUIRE( !( child_node->second.is_leaf() && child_node->second.get_range() == child_node->first && child_node->second.get_data() == node.get_data() ) );
+          return true;
+        }
+      );
+      continue;
+    }
+    if( node.get_count() != hdmap::detail::get_max_child_count< 2u >() ) continue;
+    bool uniform = true;
+    hdmap::detail::for_each_child(
+      map.nodes(),
+      node,
+      [&]( const auto &child_node, auto ) {
+        uniform =
+          child_node->second.is_leaf() &&
+          child_node->second.get_range() == child_node->first &&
+          child_node->second.get_data() == hdmap::detail::get_child( map.nodes(), node ).first->second.get_data();
+        return uniform;
+      }
+    );
+    BOOST_REQUIRE( !uniform );
+  }
+}
+
+template< typename F >
+void check_overlay( const map_t &c, const map_t &a, const map_t &b, F &&expected ) {
+  const auto a_values = get_voxels( a );
+  const auto b_values = get_voxels( b );
+  const auto c_values = get_voxels( c );
+  std::size_t count = 0u;
+  for( std::size_t i = 0u; i != c_values.size(); ++i ) {
+    const auto e = expected( a_values[ i ], b_values[ i ] );
+    BOOST_REQUIRE_EQUAL( bool( c_values[ i ] ), bool( e ) );
+    if( e ) {
+      BOOST_CHECK_EQUAL( *c_values[ i ], *e );
+      ++count;
+    }
+  }
+  BOOST_CHECK_EQUAL( c.size(), count );
+  check_merged( c );
+}
+
+BOOST_AUTO_TEST_CASE( Overlay ) {
+  for( unsigned int seed = 0u; seed != 4u; ++seed ) {
+    const auto a = random_map( seed * 2u );
+    const auto b = random_map( seed * 2u + 1u );
+    const auto max = []( unsigned int l, unsigned int r ) { return std::max( l, r ); };
+    check_overlay(
+      hdmap::overlay( a, b, max ),
+      a,
+      b,
+      [&]( const unsigned int *l, const unsigned int *r ) -> std::optional< unsigned int > {
+        if( l && r ) return max( *l, *r );
+        if( l ) return *l;
+        if( r ) return *r;
+        return std::nullopt;
+      }
+    );
+    // every voxel present in both maps becomes 0, so the result has to be merged again
+    const auto zero = []( unsigned int, unsigned int ) { return 0u; };
+    check_overlay(
+      hdmap::intersect( a, b, zero ),
+      a,
+      b,
+      [&]( const unsigned int *l, const unsigned int *r ) -> std::optional< unsigned int > {
+        if( l && r ) return 0u;
+        return std::nullopt;
+      }
+    );
+    check_overlay(
+      hdmap::subtract( a, b ),
+      a,
+      b,
+      [&]( const unsigned int *l, const unsigned int *r ) -> std::optional< unsigned int > {
+        if( l && !r ) return *l;
+        return std::nullopt;
+      }
+    );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Empty ) {
+  const auto a = random_map( 7u );
+  const map_t empty;
+  BOOST_CHECK_EQUAL( hdmap::overlay( a, empty, []( unsigned int l, unsigned int ) { return l; } ).nodes().size(), a.nodes().size() );
+  BOOST_CHECK_EQUAL( hdmap::overlay( empty, a, []( unsigned int l, unsigned int ) { return l; } ).size(), a.size() );
+  BOOST_CHECK( hdmap::intersect( a, empty, []( unsigned int l, unsigned int ) { return l; } ).empty() );
+  BOOST_CHECK( hdmap::subtract( a, a ).empty() );
+  BOOST_CHECK_EQUAL( hdmap::subtract( a, empty ).size(), a.size() );
+}
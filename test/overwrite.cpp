@@ -0,0 +1,71 @@
+#define BOOST_TEST_MODULE overwrite
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+template< typename M >
+void check_overwrite( unsigned int seed ) {
+  using C = std::remove_cvref_t< decltype( std::declval< M >().nodes() ) >;
+  M fused;
+  C classic;
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 159u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 70u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 2u );
+  for( unsigned int i = 0u; i != 40u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto range = fused.rect( fused.enc( x, y ), fused.enc( x + size( rng ), y + size( rng ) ) );
+    const auto v = value( rng );
+    if( i % 7u == 3u ) {
+      fused.erase( range );
+      hdmap::detail::erase( classic, range );
+    }
+    else {
+      fused.update( range, unsigned( v ) );
+      hdmap::detail::erase( classic, range );
+      hdmap::detail::insert( classic, v, range, std::equal_to< unsigned int >{} );
+    }
+  }
+  const M expected( std::equal_to< unsigned int >{}, std::move( classic ) );
+  BOOST_CHECK_EQUAL( fused.size(), expected.size() );
+  std::vector< typename M::key_type > points;
+  for( unsigned int y = 0u; y != 240u; ++y )
+    for( unsigned int x = 0u; x != 240u; ++x )
+      points.push_back( fused.enc( x, y ) );
+  std::vector< const unsigned int* > found( points.size() );
+  std::vector< const unsigned int* > expected_found( points.size() );
+  fused.find_points( points, found );
+  expected.find_points( points, expected_found );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    BOOST_REQUIRE_EQUAL( bool( found[ i ] ), bool( expected_found[ i ] ) );
+    if( found[ i ] ) BOOST_REQUIRE_EQUAL( *found[ i ], *expected_found[ i ] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsEraseAndInsert ) {
+  for( unsigned int seed = 0u; seed != 2u; ++seed ) {
+    check_overwrite< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u > >( seed );
+    check_overwrite< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > > >( seed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( InPlace ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  map_t map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 64u, 64u ) ), 1u );
+  map.update( map.rect( map.enc( 16u, 16u ), map.enc( 32u, 32u ) ), 2u );
+  const auto node_count = map.nodes().size();
+  // aligned to existing nodes, so nothing is split
+  map.update( map.rect( map.enc( 16u, 16u ), map.enc( 32u, 32u ) ), 3u );
+  BOOST_CHECK_EQUAL( map.nodes().size(), node_count );
+  // overwriting with the surrounding value merges back into a single node
+  map.update( map.rect( map.enc( 16u, 16u ), map.enc( 32u, 32u ) ), 1u );
+  BOOST_CHECK_EQUAL( map.nodes().size(), 1u );
+  BOOST_CHECK_EQUAL( map.size(), 64u * 64u );
+  BOOST_CHECK( !map.update( map.rect( map.enc( 5u, 5u ), map.enc( 5u, 9u ) ), 1u ) );
+}
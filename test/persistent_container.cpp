@@ -0,0 +1,189 @@
+#define BOOST_TEST_MODULE persistent_container
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/persistent_container.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+static_assert( hdmap::HDMapUnderlyingContainer< hdmap::persistent_underlying_container_t< std::uint32_t, std::string, 2u > > );
+
+using persistent_map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u, std::equal_to< std::string >, hdmap::persistent_underlying_container_t< std::uint32_t, std::string, 2u > >;
+using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+
+template< typename M >
+std::vector< std::tuple< std::uint64_t, std::uint64_t, std::string > > get_rects( const M &map ) {
+  std::vector< typename M::value_type > found;
+  map.find( map.rect( map.enc( 0u, 0u ), map.enc( 1024u, 1024u ) ), found );
+  std::vector< std::tuple< std::uint64_t, std::uint64_t, std::string > > rects;
+  for( const auto &v: found ) rects.emplace_back( v.first.left_top, v.first.right_bottom, v.second );
+  std::sort( rects.begin(), rects.end() );
+  return rects;
+}
+
+BOOST_AUTO_TEST_CASE( SameAsUnorderedMap ) {
+  hdmap::persistent_node_map< std::uint32_t, unsigned int > m;
+  std::unordered_map< std::uint32_t, unsigned int > expected;
+  std::mt19937 rng( 1u );
+  std::uniform_int_distribution< std::uint32_t > key( 0u, 4000u );
+  for( unsigned int i = 0u; i != 20000u; ++i ) {
+    const auto k = key( rng );
+    if( i % 3u == 2u ) {
+      BOOST_CHECK_EQUAL( m.erase( k ), expected.erase( k ) );
+    }
+    else {
+      BOOST_CHECK_EQUAL( m.insert( std::make_pair( k, i ) ).second, expected.insert( std::make_pair( k, i ) ).second );
+    }
+  }
+  BOOST_CHECK_EQUAL( m.size(), expected.size() );
+  std::size_t visited = 0u;
+  for( const auto &[k,v]: m ) {
+    const auto found = expected.find( k );
+    BOOST_CHECK( found != expected.end() );
+    if( found != expected.end() ) BOOST_CHECK_EQUAL( v, found->second );
+    ++visited;
+  }
+  BOOST_CHECK_EQUAL( visited, expected.size() );
+  // erasing through the iterator visits the rest of the elements
+  for( auto iter = m.begin(); iter != m.end(); ) {
+    if( iter->first % 2u ) iter = m.erase( iter );
+    else ++iter;
+  }
+  std::erase_if( expected, []( const auto &v ) { return v.first % 2u; } );
+  BOOST_CHECK_EQUAL( m.size(), expected.size() );
+  for( const auto &[k,v]: expected ) {
+    const auto found = std::as_const( m ).find( k );
+    BOOST_CHECK( found != m.end() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CopiesAreIndependent ) {
+  hdmap::persistent_node_map< std::uint32_t, unsigned int > m;
+  for( unsigned int i = 0u; i != 1000u; ++i ) m.insert( std::make_pair( i, i ) );
+  const auto copied = m;
+  // the keys which are not there are looked up and erased without copying the paths to them
+  for( unsigned int i = 1000u; i != 2000u; ++i ) {
+    BOOST_CHECK( m.find( i ) == m.end() );
+    BOOST_CHECK_EQUAL( m.erase( i ), 0u );
+  }
+  for( unsigned int i = 0u; i != 1000u; i += 2u ) m.erase( i );
+  for( unsigned int i = 1u; i < 1000u; i += 2u ) m.find( i )->second = 0u;
+  m.insert( std::make_pair( 5000u, 1u ) );
+  BOOST_CHECK_EQUAL( m.size(), 501u );
+  BOOST_CHECK_EQUAL( copied.size(), 1000u );
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    const auto found = copied.find( i );
+    BOOST_CHECK( found != copied.end() );
+    if( found != copied.end() ) BOOST_CHECK_EQUAL( found->second, i );
+  }
+  BOOST_CHECK( copied.find( 5000u ) == copied.end() );
+}
+
+BOOST_AUTO_TEST_CASE( IteratorsCopyShared ) {
+  hdmap::persistent_node_map< std::uint32_t, unsigned int > m;
+  std::unordered_map< std::uint32_t, unsigned int > expected;
+  for( unsigned int i = 0u; i != 1000u; ++i ) {
+    m.insert( std::make_pair( i, i ) );
+    expected.insert( std::make_pair( i, i ) );
+  }
+  const auto copied = m;
+  for( auto &[ key, value ]: m ) {
+    value += 1u;
+    ++expected[ key ];
+  }
+  // the iterator returned by erase and the ones advanced from find are written too
+  expected.erase( 0u );
+  for( auto iter = m.erase( m.find( 0u ) ); iter != m.end(); ++iter ) {
+    iter->second += 1u;
+    ++expected[ iter->first ];
+  }
+  for( auto iter = m.find( 1u ); iter != m.end(); ++iter ) {
+    iter->second += 1u;
+    ++expected[ iter->first ];
+  }
+  BOOST_CHECK_EQUAL( m.size(), 999u );
+  for( unsigned int i = 1u; i != 1000u; ++i ) {
+    BOOST_CHECK_EQUAL( m.find( i )->second, expected[ i ] );
+    BOOST_CHECK_EQUAL( copied.find( i )->second, i );
+  }
+  BOOST_CHECK_EQUAL( copied.find( 0u )->second, 0u );
+}
+
+BOOST_AUTO_TEST_CASE( SameAsStandardContainer ) {
+  persistent_map_t persistent;
+  map_t standard;
+  std::mt19937 rng( 2u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 900u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 80u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  const std::vector< std::string > values{ "a", "b", "c", "d" };
+  for( unsigned int i = 0u; i != 300u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    const auto w = size( rng );
+    const auto h = size( rng );
+    if( i % 4u == 3u ) {
+      persistent.erase( persistent.rect( persistent.enc( x, y ), persistent.enc( x + w, y + h ) ) );
+      standard.erase( standard.rect( standard.enc( x, y ), standard.enc( x + w, y + h ) ) );
+    }
+    else {
+      const auto index = value( rng );
+      persistent.update( persistent.rect( persistent.enc( x, y ), persistent.enc( x + w, y + h ) ), std::string( values[ index ] ) );
+      standard.update( standard.rect( standard.enc( x, y ), standard.enc( x + w, y + h ) ), std::string( values[ index ] ) );
+    }
+  }
+  BOOST_CHECK_EQUAL( persistent.nodes().size(), standard.nodes().size() );
+  BOOST_CHECK_EQUAL( persistent.size(), standard.size() );
+  BOOST_CHECK( get_rects( persistent ) == get_rects( standard ) );
+}
+
+BOOST_AUTO_TEST_CASE( SnapshotIsUnchanged ) {
+  persistent_map_t map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 500u, 500u ) ), "hello" );
+  map.update( map.rect( map.enc( 100u, 100u ), map.enc( 200u, 130u ) ), "world" );
+  const auto snapshot = map.snapshot();
+  const auto expected = get_rects( snapshot );
+  const auto expected_size = snapshot.size();
+  map.update( map.rect( map.enc( 50u, 70u ), map.enc( 300u, 90u ) ), "foo" );
+  map.erase( map.rect( map.enc( 150u, 0u ), map.enc( 160u, 500u ) ) );
+  BOOST_CHECK( get_rects( snapshot ) == expected );
+  BOOST_CHECK_EQUAL( snapshot.size(), expected_size );
+  BOOST_CHECK( get_rects( map ) != expected );
+}
+
+BOOST_AUTO_TEST_CASE( ReadSnapshotWhileUpdating ) {
+  persistent_map_t map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 512u, 512u ) ), "a" );
+  const auto snapshot = map.snapshot();
+  const auto expected = get_rects( snapshot );
+  std::atomic< bool > done( false );
+  std::atomic< unsigned int > mismatches( 0u );
+  std::thread reader(
+    [&]() {
+      // the map keeps being modified until the reader has compared at least once
+      do {
+        if( get_rects( snapshot ) != expected ) ++mismatches;
+      } while( !done.load() );
+    }
+  );
+  std::mt19937 rng( 3u );
+  std::uniform_int_distribution< unsigned int > position( 0u, 500u );
+  for( unsigned int i = 0u; i != 2000u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    map.update( map.rect( map.enc( x, y ), map.enc( x + 7u, y + 5u ) ), std::string( i % 2u ? "b" : "c" ) );
+    if( i % 5u == 0u ) map.erase( map.rect( map.enc( y, x ), map.enc( y + 3u, x + 9u ) ) );
+  }
+  done.store( true );
+  reader.join();
+  BOOST_CHECK_EQUAL( mismatches.load(), 0u );
+  BOOST_CHECK( get_rects( snapshot ) == expected );
+}
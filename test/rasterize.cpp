@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE rasterize
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+using map3_t = hdmap::hdmap< std::uint32_t, unsigned int, 3u >;
+
+template< typename M >
+M random_map( std::mt19937 &rng, unsigned int max_position, unsigned int count ) {
+  constexpr auto dims = hdmap::detail::extract_dims_v< std::remove_cvref_t< decltype( std::declval< const M& >().nodes() ) > >;
+  std::uniform_int_distribution< unsigned int > position( 0u, max_position );
+  std::uniform_int_distribution< unsigned int > size( 1u, 40u );
+  std::uniform_int_distribution< unsigned int > value( 1u, 3u );
+  M map;
+  for( unsigned int i = 0u; i != count; ++i ) {
+    typename M::rect_type range;
+    for( unsigned int j = 0u; j != dims; ++j ) {
+      const auto p = position( rng );
+      hdmap::detail::set_component< typename M::key_type, dims >( j, range.left_top, p );
+      hdmap::detail::set_component< typename M::key_type, dims >( j, range.right_bottom, p + size( rng ) );
+    }
+    if( i % 4u == 3u ) map.erase( range );
+    else map.update( range, unsigned( value( rng ) ) );
+  }
+  return map;
+}
+
+BOOST_AUTO_TEST_CASE( SameAsFindPoints ) {
+  std::mt19937 rng( 1u );
+  const auto map = random_map< map_t >( rng, 200u, 300u );
+  // ranges inside the map, crossing its edge, and outside the 16384 voxels a 32bit 2D key can encode
+  for( const auto &[x,y,w,h]: { std::array< unsigned int, 4u >{ 10u, 20u, 100u, 70u }, std::array< unsigned int, 4u >{ 0u, 0u, 256u, 256u }, std::array< unsigned int, 4u >{ 150u, 3u, 1u, 200u }, std::array< unsigned int, 4u >{ 16300u, 100u, 200u, 30u } } ) {
+    const auto range = map_t::rect( map_t::enc( x, y ), map_t::enc( x + w, y + h ) );
+    // a padded row pitch
+    const std::size_t pitch = w + 3u;
+    std::vector< unsigned int > raster( pitch * h, 100u );
+    map.rasterize( range, raster.data(), { 1u, pitch }, 0u );
+    std::vector< map_t::key_type > points;
+    for( unsigned int j = 0u; j != h; ++j )
+      for( unsigned int i = 0u; i != w; ++i )
+        points.push_back( map_t::enc( x + i, y + j ) );
+    std::vector< const unsigned int* > expected( points.size() );
+    map.find_points( points, expected );
+    for( unsigned int j = 0u; j != h; ++j ) {
+      for( unsigned int i = 0u; i != w; ++i ) {
+        const auto e = expected[ j * w + i ];
+        BOOST_CHECK_EQUAL( raster[ j * pitch + i ], e ? *e : 0u );
+      }
+      for( unsigned int i = w; i != pitch; ++i ) BOOST_CHECK_EQUAL( raster[ j * pitch + i ], 100u );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Slice ) {
+  std::mt19937 rng( 2u );
+  const auto map = random_map< map3_t >( rng, 100u, 200u );
+  for( unsigned int z: { 0u, 17u, 64u, 130u } ) {
+    // an XZ slice stored column major
+    const auto range = map3_t::rect( map3_t::enc( 5u, z, 0u ), map3_t::enc( 125u, z + 1u, 110u ) );
+    std::vector< unsigned int > raster( 120u * 110u, 100u );
+    map.rasterize( range, raster.data(), { 110u, 0u, 1u }, 9u );
+    for( unsigned int i = 0u; i != 120u; ++i ) {
+      for( unsigned int k = 0u; k != 110u; ++k ) {
+        const auto point = map3_t::enc( 5u + i, z, k );
+        const unsigned int *expected = nullptr;
+        map.find_points( std::span< const map3_t::key_type >( &point, 1u ), std::span< const unsigned int* >( &expected, 1u ) );
+        BOOST_CHECK_EQUAL( raster[ i * 110u + k ], expected ? *expected : 9u );
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( EmptyAndUniform ) {
+  map_t map;
+  std::vector< unsigned int > raster( 64u, 100u );
+  map.rasterize( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 8u, 8u ) ), raster.data(), { 1u, 8u }, 0u );
+  BOOST_CHECK( std::all_of( raster.begin(), raster.end(), []( unsigned int v ) { return v == 0u; } ) );
+  map.update( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 16384u, 16384u ) ), 5u );
+  map.rasterize( map_t::rect( map_t::enc( 1000u, 1000u ), map_t::enc( 1008u, 1008u ) ), raster.data(), { 1u, 8u }, 0u );
+  BOOST_CHECK( std::all_of( raster.begin(), raster.end(), []( unsigned int v ) { return v == 5u; } ) );
+}
@@ -3,6 +3,9 @@
 
 #include <hdmap/hdmap.hpp>
 #include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_CASE( RectangleView ) {
@@ -14,13 +17,16 @@ BOOST_AUTO_TEST_CASE( RectangleView ) {
   auto expected_values = std::views::all( copied )|hdmap::views::leaf;
   auto filtered_values = std::views::all( uc )|hdmap::views::leaf|hdmap::views::rectangle( hdmap::rectangle< std::uint64_t, 2u >{ hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 281u, 254u ), hdmap::detail::to_key< std::uint64_t, 2u >( 0u, 282u, 258u ) } );
 
-  auto expected_values_iter = expected_values.begin();
-  const auto expected_values_end = expected_values.end();
-  auto filtered_values_iter = filtered_values.begin();
-  const auto filtered_values_end = filtered_values.end();
-  for( ; expected_values_iter != expected_values_end && filtered_values_iter != filtered_values_end; ++expected_values_iter, ++filtered_values_iter ) {
-    BOOST_CHECK_EQUAL( expected_values_iter->second.get_range(), filtered_values_iter->second.get_range() );
-    BOOST_CHECK_EQUAL( expected_values_iter->second.get_data(), filtered_values_iter->second.get_data() );
+  // the containers are unordered, so the leaves are compared sorted by range
+  std::vector< std::pair< std::uint32_t, std::string > > expected;
+  for( const auto &[key,value]: expected_values ) expected.emplace_back( value.get_range(), value.get_data() );
+  std::vector< std::pair< std::uint32_t, std::string > > filtered;
+  for( const auto &[key,value]: filtered_values ) filtered.emplace_back( value.get_range(), value.get_data() );
+  std::sort( expected.begin(), expected.end() );
+  std::sort( filtered.begin(), filtered.end() );
+  BOOST_CHECK_EQUAL( expected.size(), filtered.size() );
+  for( std::size_t i = 0u; i != std::min( expected.size(), filtered.size() ); ++i ) {
+    BOOST_CHECK_EQUAL( expected[ i ].first, filtered[ i ].first );
+    BOOST_CHECK_EQUAL( expected[ i ].second, filtered[ i ].second );
   }
 }
-
@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE reduce
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+struct expected_t {
+  std::size_t count = 0u;
+  unsigned int sum = 0u;
+  std::optional< unsigned int > min;
+  std::optional< unsigned int > max;
+};
+
+// reduce the voxels of range by visiting every leaf
+template< typename M >
+expected_t reduce_leaves( const M &map, const typename M::rect_type &range ) {
+  expected_t e;
+  for( const auto &v: map.leaves() ) {
+    const auto overlap = hdmap::detail::get_overlap_count( v.first, range );
+    if( overlap == 0u ) continue;
+    e.count += overlap;
+    e.sum += v.second * unsigned( overlap );
+    if( !e.min || v.second < *e.min ) e.min = v.second;
+    if( !e.max || v.second > *e.max ) e.max = v.second;
+  }
+  return e;
+}
+
+template< typename M >
+void check_reduce( unsigned int seed ) {
+  M map;
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 200u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 60u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 9u );
+  const auto random_rect = [&]() {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    return map.rect( map.enc( x, y ), map.enc( x + size( rng ), y + size( rng ) ) );
+  };
+  const auto check = [&]( const typename M::rect_type &range ) {
+    const auto e = reduce_leaves( map, range );
+    BOOST_REQUIRE_EQUAL( map.reduce( range ), e.sum );
+    BOOST_REQUIRE_EQUAL( map.reduce( range, hdmap::sum_aggregate< unsigned int >{} ), e.sum );
+    BOOST_REQUIRE_EQUAL( map.reduce( range, hdmap::count_aggregate{} ), e.count );
+    BOOST_REQUIRE( map.reduce( range, hdmap::min_aggregate< unsigned int >{} ) == e.min );
+    BOOST_REQUIRE( map.reduce( range, hdmap::max_aggregate< unsigned int >{} ) == e.max );
+  };
+  for( unsigned int i = 0u; i != 40u; ++i ) {
+    if( i % 5u == 2u ) map.erase( random_rect() );
+    else if( i % 5u == 4u ) {
+      std::vector< typename M::value_type > updates;
+      for( unsigned int j = 0u; j != 8u; ++j ) updates.emplace_back( random_rect(), value( rng ) );
+      map.update_batch( updates );
+    }
+    else map.update( random_rect(), unsigned( value( rng ) ) );
+    if( i % 8u == 7u ) {
+      for( unsigned int j = 0u; j != 3u; ++j ) check( random_rect() );
+      check( map.rect( map.enc( 0u, 0u ), map.enc( 16384u, 16384u ) ) );
+    }
+  }
+  BOOST_CHECK_EQUAL( map.reduce( map.rect( map.enc( 0u, 0u ), map.enc( 16384u, 16384u ) ), hdmap::count_aggregate{} ), map.size() );
+  map.clear();
+  BOOST_CHECK_EQUAL( map.reduce( map.rect( map.enc( 0u, 0u ), map.enc( 16384u, 16384u ) ) ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( Reduce ) {
+  for( unsigned int seed = 0u; seed != 2u; ++seed ) {
+    check_reduce< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u >, hdmap::sum_aggregate< unsigned int > > >( seed );
+    check_reduce< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u >, hdmap::sum_aggregate< unsigned int > > >( seed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( FromContainer ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u >, hdmap::max_aggregate< unsigned int > >;
+  hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u > uc;
+  hdmap::detail::insert( uc, 1u, map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 20u, 10u ) ), std::equal_to< unsigned int >{} );
+  hdmap::detail::insert( uc, 2u, map_t::rect( map_t::enc( 0u, 10u ), map_t::enc( 5u, 12u ) ), std::equal_to< unsigned int >{} );
+  map_t map( std::equal_to< unsigned int >{}, std::move( uc ) );
+  BOOST_CHECK( map.reduce( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 64u, 64u ) ) ) == 2u );
+  BOOST_CHECK( map.reduce( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 64u, 10u ) ) ) == 1u );
+  BOOST_CHECK( !map.reduce( map_t::rect( map_t::enc( 30u, 0u ), map_t::enc( 64u, 64u ) ) ) );
+  map.update( map_t::rect( map_t::enc( 3u, 3u ), map_t::enc( 4u, 4u ) ), 7u );
+  BOOST_CHECK( map.reduce( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 64u, 10u ) ) ) == 7u );
+  map.erase( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 10u, 10u ) ) );
+  BOOST_CHECK( map.reduce( map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 64u, 10u ) ) ) == 1u );
+}
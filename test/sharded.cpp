@@ -0,0 +1,129 @@
+#define BOOST_TEST_MODULE sharded
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/sharded.hpp>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using sharded_t = hdmap::sharded_hdmap< std::uint32_t, unsigned int, 2u >;
+using map_t = hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+
+sharded_t::rect_type random_rect( std::mt19937 &rng, unsigned int max_position, unsigned int max_size ) {
+  std::uniform_int_distribution< unsigned int > position( 0u, max_position );
+  std::uniform_int_distribution< unsigned int > size( 1u, max_size );
+  const auto x = position( rng );
+  const auto y = position( rng );
+  return sharded_t::rect( sharded_t::enc( x, y ), sharded_t::enc( x + size( rng ), y + size( rng ) ) );
+}
+
+// Both maps hold the same voxels if every random window has the same number of voxels holding each value
+void check_same( const sharded_t &sharded, const map_t &expected, std::mt19937 &rng ) {
+  BOOST_CHECK_EQUAL( sharded.size(), expected.size() );
+  for( unsigned int i = 0u; i != 20u; ++i ) {
+    const auto range = random_rect( rng, 16000u, 2000u );
+    BOOST_CHECK_EQUAL( sharded.count( range ), expected.count( range ) );
+    BOOST_CHECK_EQUAL( sharded.any( range ), expected.any( range ) );
+    for( unsigned int v = 0u; v != 4u; ++v )
+      BOOST_CHECK_EQUAL( sharded.count_if( range, [&]( unsigned int x ) { return x == v; } ), expected.count_if( range, [&]( unsigned int x ) { return x == v; } ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ShardIndex ) {
+  for( unsigned int i = 0u; i != sharded_t::shard_count; ++i ) {
+    sharded_t map;
+    const auto &range = map.get_shard_range( i );
+    BOOST_CHECK_EQUAL( sharded_t::get_shard_index( range.left_top ), i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsHDMap ) {
+  sharded_t sharded;
+  map_t expected;
+  std::mt19937 rng( 1u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  // large rectangles span several shards
+  for( unsigned int i = 0u; i != 80u; ++i ) {
+    const auto range = random_rect( rng, 16000u, i % 4u ? 100u : 2000u );
+    if( i % 5u == 4u ) {
+      BOOST_CHECK_EQUAL( sharded.erase( range ), expected.erase( range ) );
+    }
+    else {
+      const auto v = value( rng );
+      sharded.update( range, unsigned( v ) );
+      expected.update( range, unsigned( v ) );
+    }
+  }
+  check_same( sharded, expected, rng );
+  std::vector< sharded_t::value_type > batch;
+  for( unsigned int i = 0u; i != 30u; ++i ) batch.emplace_back( random_rect( rng, 16000u, 1500u ), value( rng ) );
+  sharded.update_batch( batch );
+  expected.update_batch( batch );
+  check_same( sharded, expected, rng );
+  // the found rectangles cover the same voxels with the same values
+  const auto window = sharded_t::rect( sharded_t::enc( 3000u, 3000u ), sharded_t::enc( 6000u, 5000u ) );
+  std::vector< sharded_t::value_type > found;
+  sharded.find( window, found );
+  std::size_t found_count = 0u;
+  for( const auto &[range,v]: found ) {
+    found_count += hdmap::detail::get_max_leaf_count( range );
+    BOOST_CHECK_EQUAL( expected.count_if( range, [&]( unsigned int x ) { return x == v; } ), hdmap::detail::get_max_leaf_count( range ) );
+  }
+  BOOST_CHECK_EQUAL( found_count, expected.count( window ) );
+  std::vector< sharded_t::key_type > points;
+  std::uniform_int_distribution< unsigned int > position( 0u, 16383u );
+  for( unsigned int i = 0u; i != 1000u; ++i ) points.push_back( sharded_t::enc( position( rng ), position( rng ) ) );
+  std::vector< std::optional< unsigned int > > values( points.size() );
+  std::vector< const unsigned int* > expected_values( points.size() );
+  sharded.find_points( points, values );
+  expected.find_points( points, expected_values );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    BOOST_CHECK_EQUAL( bool( values[ i ] ), bool( expected_values[ i ] ) );
+    if( values[ i ] && expected_values[ i ] ) BOOST_CHECK_EQUAL( *values[ i ], *expected_values[ i ] );
+  }
+  sharded.clear();
+  BOOST_CHECK( sharded.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( ParallelWriters ) {
+  sharded_t sharded;
+  map_t expected;
+  // each writer updates its own quarter of the space, and the rectangles cross the shard boundaries inside it
+  std::vector< std::vector< sharded_t::rect_type > > ranges( 4u );
+  std::mt19937 rng( 2u );
+  for( unsigned int w = 0u; w != 4u; ++w ) {
+    const auto x = ( w & 1u ) * 8192u;
+    const auto y = ( w >> 1u ) * 8192u;
+    std::uniform_int_distribution< unsigned int > position( 3800u, 4200u );
+    std::uniform_int_distribution< unsigned int > size( 1u, 200u );
+    for( unsigned int i = 0u; i != 60u; ++i ) {
+      const auto px = x + position( rng );
+      const auto py = y + position( rng );
+      ranges[ w ].push_back( sharded_t::rect( sharded_t::enc( px, py ), sharded_t::enc( px + size( rng ), py + size( rng ) ) ) );
+    }
+  }
+  std::vector< std::thread > writers;
+  for( unsigned int w = 0u; w != 4u; ++w ) {
+    writers.emplace_back(
+      [&, w]() {
+        for( unsigned int i = 0u; i != ranges[ w ].size(); ++i ) {
+          if( i % 4u == 3u ) sharded.erase( ranges[ w ][ i ] );
+          else sharded.update( ranges[ w ][ i ], unsigned( i % 3u ) );
+        }
+      }
+    );
+  }
+  for( auto &writer: writers ) writer.join();
+  for( unsigned int w = 0u; w != 4u; ++w ) {
+    for( unsigned int i = 0u; i != ranges[ w ].size(); ++i ) {
+      if( i % 4u == 3u ) expected.erase( ranges[ w ][ i ] );
+      else expected.update( ranges[ w ][ i ], unsigned( i % 3u ) );
+    }
+  }
+  check_same( sharded, expected, rng );
+}
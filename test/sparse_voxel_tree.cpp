@@ -0,0 +1,61 @@
+#define BOOST_TEST_MODULE sparse_voxel_tree
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/sparse_voxel_tree.hpp>
+#include <cstdint>
+#include <bit>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE( PointQuery ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+  map_t map;
+  map.update( map.rect( map.enc( 0u, 0u ), map.enc( 200u, 150u ) ), "hello" );
+  for( unsigned int i = 0u; i != 10u; ++i ) {
+    const auto x = 7u + i * 19u;
+    const auto y = 3u + i * 13u;
+    map.update( map.rect( map.enc( x, y ), map.enc( x + 9u, y + 4u ) ), "world" );
+  }
+  map.erase( map.rect( map.enc( 50u, 50u ), map.enc( 70u, 61u ) ) );
+  const auto tree = hdmap::make_sparse_voxel_tree( map );
+  // a child of an inherited node holding the inherited value is a leaf of the tree
+  std::size_t inherited = 0u;
+  for( const auto &v: map.nodes() ) inherited += std::popcount( v.second.get_inherited_children() );
+  BOOST_CHECK_EQUAL( tree.node_count(), map.nodes().size() + inherited );
+  for( unsigned int y = 0u; y != 160u; ++y ) {
+    for( unsigned int x = 0u; x != 210u; ++x ) {
+      std::vector< map_t::value_type > expected;
+      map.find( map.rect( map.enc( x, y ), map.enc( x + 1u, y + 1u ) ), expected );
+      const auto found = tree.find( map.enc( x, y ) );
+      if( expected.empty() ) {
+        BOOST_CHECK( found == nullptr );
+      }
+      else {
+        BOOST_REQUIRE( found != nullptr );
+        BOOST_CHECK_EQUAL( *found, expected[ 0 ].second );
+      }
+    }
+  }
+  BOOST_CHECK( tree.find( map.enc( 20000u, 0u ) ) == nullptr );
+}
+
+BOOST_AUTO_TEST_CASE( LeafTraversal ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, std::string, 2u >;
+  map_t map;
+  map.update( map.rect( map.enc( 10u, 20u ), map.enc( 300u, 90u ) ), "hello" );
+  map.update( map.rect( map.enc( 40u, 30u ), map.enc( 55u, 70u ) ), "world" );
+  const auto tree = hdmap::make_sparse_voxel_tree( map );
+  std::size_t hello = 0u;
+  std::size_t world = 0u;
+  tree.for_each_leaf(
+    map.rect( map.enc( 30u, 25u ), map.enc( 60u, 65u ) ),
+    [&]( const auto &range, const auto &value ) {
+      const auto count = hdmap::detail::get_overlap_count( range, range );
+      if( value == "hello" ) hello += count;
+      else if( value == "world" ) world += count;
+    }
+  );
+  BOOST_CHECK_EQUAL( world, 15u * 35u );
+  BOOST_CHECK_EQUAL( hello, 30u * 40u - 15u * 35u );
+  BOOST_CHECK( hdmap::make_sparse_voxel_tree( map_t() ).empty() );
+}
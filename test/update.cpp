@@ -33,16 +33,16 @@ BOOST_AUTO_TEST_CASE( Update ) {
     }
     {
       unsigned int count = 0u;
-      for( const auto &[key,value]: uc ) {
-        if( value.is_leaf() ) ++count;
-      }
+      for( [[maybe_unused]] const auto &v: std::views::all( uc )|hdmap::views::leaf ) ++count;
       BOOST_CHECK_EQUAL( count, 76u );
+      // the split leaves are inherited nodes on the path to the updated slot
+      BOOST_CHECK_EQUAL( uc.size(), 6u );
     }
     {
       auto found = hdmap::detail::find( uc, hdmap::detail::to_key< std::uint32_t, 2u >( 0u, 1u, 2u ) );
       BOOST_CHECK( found != uc.end() );
-      BOOST_CHECK_EQUAL( found->second.get_range(), ( hdmap::detail::to_key< std::uint32_t, 2u >( 4u, 0u, 0u ) ) );
-      BOOST_CHECK_EQUAL( found->second.is_leaf(), true );
+      BOOST_CHECK_EQUAL( found->second.get_range(), ( hdmap::detail::to_key< std::uint32_t, 2u >( 5u, 0u, 0u ) ) );
+      BOOST_CHECK_EQUAL( found->second.is_inherited(), true );
       BOOST_CHECK_EQUAL( found->second.get_data(), "fuga" );
     }
     {
@@ -75,16 +75,16 @@ BOOST_AUTO_TEST_CASE( Update ) {
     }
     {
       unsigned int count = 0u;
-      for( const auto &[key,value]: uc ) {
-        if( value.is_leaf() ) ++count;
-      }
+      for( [[maybe_unused]] const auto &v: std::views::all( uc )|hdmap::views::leaf ) ++count;
       BOOST_CHECK_EQUAL( count, 61u );
+      // the split leaves are inherited nodes on the path to the updated slot
+      BOOST_CHECK_EQUAL( uc.size(), 5u );
     }
     {
       auto found = hdmap::detail::find( uc, hdmap::detail::to_key< std::uint32_t, 2u >( 0u, 1u, 2u ) );
       BOOST_CHECK( found != uc.end() );
-      BOOST_CHECK_EQUAL( found->second.get_range(), ( hdmap::detail::to_key< std::uint32_t, 2u >( 4u, 0u, 0u ) ) );
-      BOOST_CHECK_EQUAL( found->second.is_leaf(), true );
+      BOOST_CHECK_EQUAL( found->second.get_range(), ( hdmap::detail::to_key< std::uint32_t, 2u >( 5u, 0u, 0u ) ) );
+      BOOST_CHECK_EQUAL( found->second.is_inherited(), true );
       BOOST_CHECK_EQUAL( found->second.get_data(), "fuga" );
     }
     {
@@ -0,0 +1,66 @@
+#define BOOST_TEST_MODULE update_batch
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+template< typename M >
+void check_update_batch( unsigned int seed ) {
+  M sequential;
+  M batched;
+  sequential.update( sequential.rect( sequential.enc( 0u, 0u ), sequential.enc( 256u, 256u ) ), 0u );
+  batched.update( batched.rect( batched.enc( 0u, 0u ), batched.enc( 256u, 256u ) ), 0u );
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 255u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 40u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 2u );
+  std::vector< typename M::value_type > updates;
+  for( unsigned int i = 0u; i != 50u; ++i ) {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    updates.emplace_back( sequential.rect( sequential.enc( x, y ), sequential.enc( x + size( rng ), y + size( rng ) ) ), value( rng ) );
+  }
+  // finish with large overwrites so that merging has something to do
+  updates.emplace_back( sequential.rect( sequential.enc( 0u, 0u ), sequential.enc( 128u, 128u ) ), 1u );
+  updates.emplace_back( sequential.rect( sequential.enc( 64u, 64u ), sequential.enc( 192u, 256u ) ), 1u );
+  for( const auto &[range,v]: updates )
+    sequential.update( range, unsigned( v ) );
+  batched.update_batch( updates );
+  BOOST_CHECK_EQUAL( batched.size(), sequential.size() );
+  // the nodes stored depend on the order the leaves were split in, so the leaves are compared
+  BOOST_CHECK_LE( std::ranges::distance( batched.leaves() ), std::ranges::distance( sequential.leaves() ) );
+  std::vector< typename M::key_type > points;
+  for( unsigned int y = 0u; y != 260u; ++y )
+    for( unsigned int x = 0u; x != 260u; ++x )
+      points.push_back( sequential.enc( x, y ) );
+  std::vector< const unsigned int* > expected( points.size() );
+  std::vector< const unsigned int* > found( points.size() );
+  sequential.find_points( points, expected );
+  batched.find_points( points, found );
+  for( std::size_t i = 0u; i != points.size(); ++i ) {
+    BOOST_REQUIRE_EQUAL( bool( found[ i ] ), bool( expected[ i ] ) );
+    if( found[ i ] ) BOOST_REQUIRE_EQUAL( *found[ i ], *expected[ i ] );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SameAsSequential ) {
+  for( unsigned int seed = 0u; seed != 2u; ++seed ) {
+    check_update_batch< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u > >( seed );
+    check_update_batch< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > > >( seed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( MergeIntoRoot ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  map_t map;
+  std::vector< map_t::value_type > updates;
+  for( unsigned int y = 0u; y != 4u; ++y )
+    for( unsigned int x = 0u; x != 4u; ++x )
+      updates.emplace_back( map.rect( map.enc( x * 4096u, y * 4096u ), map.enc( x * 4096u + 4096u, y * 4096u + 4096u ) ), 7u );
+  map.update_batch( updates );
+  BOOST_CHECK_EQUAL( map.nodes().size(), 1u );
+  BOOST_CHECK_EQUAL( map.size(), 16384u * 16384u );
+}
@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE volume
+#define BOOST_TEST_DYN_LINK
+
+#include <hdmap/hdmap.hpp>
+#include <hdmap/flat_container.hpp>
+#include <cstdint>
+#include <array>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+// the voxel count of each value by visiting every leaf
+template< typename M >
+std::array< std::size_t, 4u > count_voxels( const M &map ) {
+  std::array< std::size_t, 4u > sum{};
+  for( const auto &v: map.leaves() ) sum[ v.second ] += hdmap::detail::get_max_leaf_count( v.first );
+  return sum;
+}
+
+template< typename M >
+void check_volume( unsigned int seed ) {
+  M map;
+  map.enable_volumes();
+  std::mt19937 rng( seed );
+  std::uniform_int_distribution< unsigned int > position( 0u, 200u );
+  std::uniform_int_distribution< unsigned int > size( 1u, 60u );
+  std::uniform_int_distribution< unsigned int > value( 0u, 3u );
+  const auto random_rect = [&]() {
+    const auto x = position( rng );
+    const auto y = position( rng );
+    return map.rect( map.enc( x, y ), map.enc( x + size( rng ), y + size( rng ) ) );
+  };
+  for( unsigned int i = 0u; i != 60u; ++i ) {
+    if( i % 5u == 2u ) {
+      const auto before = map.size();
+      const auto erased = map.erase( random_rect() );
+      BOOST_CHECK_EQUAL( map.size(), before - erased );
+    }
+    else if( i % 5u == 4u ) {
+      std::vector< typename M::value_type > updates;
+      for( unsigned int j = 0u; j != 8u; ++j ) updates.emplace_back( random_rect(), value( rng ) );
+      map.update_batch( updates );
+    }
+    else map.update( random_rect(), unsigned( value( rng ) ) );
+    if( i % 10u == 9u ) {
+      const auto expected = count_voxels( map );
+      BOOST_REQUIRE_EQUAL( map.size(), expected[ 0 ] + expected[ 1 ] + expected[ 2 ] + expected[ 3 ] );
+      for( unsigned int v = 0u; v != 4u; ++v )
+        BOOST_REQUIRE_EQUAL( map.volume( v ), expected[ v ] );
+    }
+  }
+  BOOST_CHECK( !map.empty() );
+  map.clear();
+  BOOST_CHECK_EQUAL( map.size(), 0u );
+  BOOST_CHECK_EQUAL( map.volume( 0u ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( Volume ) {
+  for( unsigned int seed = 0u; seed != 2u; ++seed ) {
+    check_volume< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u > >( seed );
+    check_volume< ::hdmap::hdmap< std::uint32_t, unsigned int, 2u, std::equal_to< unsigned int >, hdmap::flat_underlying_container_t< std::uint32_t, unsigned int, 2u > > >( seed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( FromContainer ) {
+  using map_t = ::hdmap::hdmap< std::uint32_t, unsigned int, 2u >;
+  hdmap::standard_underlying_container_t< std::uint32_t, unsigned int, 2u > uc;
+  hdmap::detail::insert( uc, 1u, map_t::rect( map_t::enc( 0u, 0u ), map_t::enc( 20u, 10u ) ), std::equal_to< unsigned int >{} );
+  hdmap::detail::insert( uc, 2u, map_t::rect( map_t::enc( 0u, 10u ), map_t::enc( 5u, 12u ) ), std::equal_to< unsigned int >{} );
+  map_t map( std::equal_to< unsigned int >{}, std::move( uc ) );
+  BOOST_CHECK_EQUAL( map.size(), 210u );
+  BOOST_CHECK( !map.volumes_enabled() );
+  BOOST_CHECK_EQUAL( map.volume( 2u ), 10u );
+  map.enable_volumes();
+  BOOST_CHECK( map.volumes_enabled() );
+  BOOST_CHECK_EQUAL( map.volume( 1u ), 200u );
+  BOOST_CHECK_EQUAL( map.volume( 2u ), 10u );
+  BOOST_CHECK_EQUAL( map.volume( 3u ), 0u );
+  // partly outside of the map
+  map.update( map_t::rect( map_t::enc( 16380u, 0u ), map_t::enc( 16390u, 1u ) ), 3u );
+  BOOST_CHECK_EQUAL( map.volume( 3u ), 4u );
+  BOOST_CHECK_EQUAL( map.size(), 214u );
+}